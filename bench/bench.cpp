@@ -0,0 +1,1015 @@
+// Microbenchmarks for the fenz headers.
+//
+// Build and run from the repository root:
+//     g++ -std=c++14 -O2 -march=native -I. bench/bench.cpp -pthread -o fenz-bench
+//     ./fenz-bench [filter] > results.json
+//
+// Results are written to stdout as JSON, and a readable summary to stderr. The optional filter only runs benchmarks
+// whose name contains it, e.g. `./fenz-bench queue/`.
+
+#define FENZ_TIME_SOURCE_MONOTONIC
+#define FENZ_PROFILE
+
+#include "../fenz/time_sources.hpp"
+
+#include "../fenz/array.hpp"
+#include "../fenz/bitarray.hpp"
+#include "../fenz/blocking_queue.hpp"
+#include "../fenz/cached_clock.hpp"
+#include "../fenz/deque.hpp"
+#include "../fenz/hash.hpp"
+#include "../fenz/histogram.hpp"
+#include "../fenz/mapped.hpp"
+#include "../fenz/option.hpp"
+#include "../fenz/priority_queue.hpp"
+#include "../fenz/profiler.hpp"
+#include "../fenz/queue.hpp"
+#include "../fenz/rate_limit.hpp"
+#include "../fenz/scan.hpp"
+#include "../fenz/scheduler.hpp"
+#include "../fenz/search.hpp"
+#include "../fenz/serialize.hpp"
+#include "../fenz/shm_queue.hpp"
+#include "../fenz/sort.hpp"
+#include "../fenz/timer_wheel.hpp"
+#include "../fenz/window.hpp"
+#include "harness.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <queue>
+#include <string>
+#include <vector>
+
+using bench::doNotOptimize;
+
+namespace
+{
+    /// A fast deterministic generator for benchmark inputs.
+    struct Random
+    {
+        unsigned long long state;
+
+        unsigned int next()
+        {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            return static_cast<unsigned int>(state >> 33);
+        }
+    };
+
+    struct Large
+    {
+        long long words[8];
+    };
+
+    void benchQueue(bench::Runner &runner)
+    {
+        static fenz::Queue<int, 1024> queue;
+        runner.run("queue/enqueue_dequeue", 1024, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           queue.enqueue(static_cast<int>(i));
+                           doNotOptimize(queue.dequeue());
+                       } });
+        runner.run("queue/fill_drain", 1024, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += 1024)
+                       {
+                           for (int j = 0; j < 1024; ++j)
+                           {
+                               queue.enqueue(j);
+                           }
+                           queue.dequeueAll([](int &item) { doNotOptimize(item); });
+                       } }, 1024);
+        runner.run("queue/force_enqueue", 1024, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           queue.forceEnqueue(static_cast<int>(i));
+                       }
+                       doNotOptimize(queue.size()); });
+        queue.dequeueAll([](int &) {});
+    }
+
+    void benchDeque(bench::Runner &runner)
+    {
+        static fenz::Deque<int, 1024> deque;
+        runner.run("deque/push_back_pop_front", 1024, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           deque.pushBack(static_cast<int>(i));
+                           doNotOptimize(deque.popFront());
+                       } });
+        runner.run("deque/push_front_pop_back", 1024, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           deque.pushFront(static_cast<int>(i));
+                           doNotOptimize(deque.popBack());
+                       } });
+    }
+
+    void benchOption(bench::Runner &runner)
+    {
+        runner.run("option/copy_int", 4, [](long long iterations)
+                   {
+                       fenz::Option<int> source(42);
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(source);
+                           fenz::Option<int> copy(source);
+                           doNotOptimize(copy);
+                       } });
+        runner.run("option/copy_large", sizeof(Large), [](long long iterations)
+                   {
+                       fenz::Option<Large> source(Large{{1, 2, 3, 4, 5, 6, 7, 8}});
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(source);
+                           fenz::Option<Large> copy(source);
+                           doNotOptimize(copy);
+                       } });
+        // Constructing an Option from a temporary moves it, but Option has no move assignment, so assigning a temporary
+        // goes through the copy assignment
+        runner.run("option/assign_temporary_large", sizeof(Large), [](long long iterations)
+                   {
+                       fenz::Option<Large> target;
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           target = fenz::Option<Large>(Large{{i, 2, 3, 4, 5, 6, 7, 8}});
+                           doNotOptimize(target);
+                       } });
+        runner.run("option/value_or", 4, [](long long iterations)
+                   {
+                       fenz::Option<int> present(1);
+                       fenz::Option<int> absent;
+                       long long sum = 0;
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(present);
+                           doNotOptimize(absent);
+                           sum += present.valueOr(0) + absent.valueOr(2);
+                       }
+                       doNotOptimize(sum); });
+    }
+
+    template <int N>
+    void benchIteration(bench::Runner &runner)
+    {
+        static fenz::Array<int, N> left(1);
+        static fenz::Array<int, N> right(2);
+
+        runner.run("iterate/raw_loop", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           long long sum = 0;
+                           int *data = left.begin();
+                           for (int j = 0; j < N; ++j)
+                           {
+                               sum += data[j];
+                           }
+                           doNotOptimize(sum);
+                           bench::clobberMemory();
+                       } }, N);
+        runner.run("iterate/enumerate", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           long long sum = 0;
+                           left.enumerate([&sum](int &item, int) { sum += item; });
+                           doNotOptimize(sum);
+                           bench::clobberMemory();
+                       } }, N);
+        runner.run("iterate/raw_zip", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           long long sum = 0;
+                           int *a = left.begin();
+                           int *b = right.begin();
+                           for (int j = 0; j < N; ++j)
+                           {
+                               sum += a[j] * b[j];
+                           }
+                           doNotOptimize(sum);
+                           bench::clobberMemory();
+                       } }, N);
+        runner.run("iterate/zip", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           long long sum = 0;
+                           left.zip(right, [&sum](int &a, int &b) { sum += a * b; });
+                           doNotOptimize(sum);
+                           bench::clobberMemory();
+                       } }, N);
+    }
+
+    void benchTime(bench::Runner &runner)
+    {
+        runner.run("time/nano_moment_now", 0, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(fenz::NanoMoment::now());
+                       } });
+        runner.run("time/moment_now", 0, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(fenz::Moment::now());
+                       } });
+        runner.run("time/source_monotonic", 0, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(fenz::monotonicClockNanos());
+                       } });
+        runner.run("time/source_monotonic_coarse", 0, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(fenz::monotonicCoarseClockNanos());
+                       } });
+        fenz::tscCalibration();
+        runner.run("time/source_tsc", fenz::tscCalibration().usable ? 1 : 0, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(fenz::tscClockNanos());
+                       } });
+
+        static fenz::BasicCachedClock<fenz::NanoMoment> cached(fenz::Nanoseconds::fromMillis(1));
+        runner.run("time/cached_clock_now", 0, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(cached.now());
+                       } });
+    }
+
+    template <unsigned int N>
+    void benchPriorityQueue(bench::Runner &runner)
+    {
+        static fenz::PriorityQueue<unsigned int, N> heap;
+        static std::vector<unsigned int> keys(N);
+        Random random = {N};
+        for (unsigned int i = 0; i < N; ++i)
+        {
+            keys[i] = random.next();
+        }
+
+        runner.run("priority_queue/fenz_push_pop", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           for (unsigned int j = 0; j < N; ++j)
+                           {
+                               heap.push(keys[j]);
+                           }
+                           heap.popAll([](const unsigned int &key) { doNotOptimize(key); });
+                       } }, N);
+        runner.run("priority_queue/std_push_pop", N, [](long long iterations)
+                   {
+                       std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<unsigned int>> stdHeap;
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           for (unsigned int j = 0; j < N; ++j)
+                           {
+                               stdHeap.push(keys[j]);
+                           }
+                           while (!stdHeap.empty())
+                           {
+                               doNotOptimize(stdHeap.top());
+                               stdHeap.pop();
+                           }
+                       } }, N);
+    }
+
+    /// Schedules N timers with random deadlines in the next minute, then advances through them in 1 ms steps.
+    template <unsigned int N>
+    void benchTimers(bench::Runner &runner)
+    {
+        static std::vector<long long> delays(N);
+        Random random = {N * 7};
+        for (unsigned int i = 0; i < N; ++i)
+        {
+            delays[i] = random.next() % 60000;
+        }
+
+        runner.run("timers/timer_wheel", N, [](long long iterations)
+                   {
+                       static fenz::TimerWheel<unsigned int, N> wheel(fenz::Moment::fromTicks(0));
+                       static long long now = 0;
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           fenz::Moment start = fenz::Moment::fromTicks(now);
+                           for (unsigned int j = 0; j < N; ++j)
+                           {
+                               wheel.schedule(start + fenz::Duration::fromMillis(delays[j]), j);
+                           }
+                           for (long long t = 1; t <= 60000; ++t)
+                           {
+                               wheel.advance(fenz::Moment::fromTicks(now + t), [](unsigned int &item) { doNotOptimize(item); });
+                           }
+                           now += 60000;
+                       } }, N);
+
+        struct Timer
+        {
+            long long deadline;
+            unsigned int item;
+
+            bool operator<(const Timer &other) const
+            {
+                return deadline < other.deadline;
+            }
+
+            bool operator>(const Timer &other) const
+            {
+                return deadline > other.deadline;
+            }
+        };
+        runner.run("timers/priority_queue", N, [](long long iterations)
+                   {
+                       static fenz::PriorityQueue<Timer, N> heap;
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           for (unsigned int j = 0; j < N; ++j)
+                           {
+                               heap.push(Timer{delays[j], j});
+                           }
+                           for (long long t = 1; t <= 60000; ++t)
+                           {
+                               while (!heap.isEmpty() && heap.peek().value_unsafely().deadline <= t)
+                               {
+                                   doNotOptimize(heap.pop());
+                               }
+                           }
+                       } }, N);
+        runner.run("timers/std_priority_queue", N, [](long long iterations)
+                   {
+                       std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> stdHeap;
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           for (unsigned int j = 0; j < N; ++j)
+                           {
+                               stdHeap.push(Timer{delays[j], j});
+                           }
+                           for (long long t = 1; t <= 60000; ++t)
+                           {
+                               while (!stdHeap.empty() && stdHeap.top().deadline <= t)
+                               {
+                                   doNotOptimize(stdHeap.top());
+                                   stdHeap.pop();
+                               }
+                           }
+                       } }, N);
+    }
+
+    void benchBitArray(bench::Runner &runner)
+    {
+        static fenz::BitArray<4096> bits;
+        Random random = {3};
+        for (int i = 0; i < 4096; ++i)
+        {
+            bits.set(i, random.next() % 4 == 0);
+        }
+        runner.run("bitarray/count", 4096, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(bits.count());
+                           bench::clobberMemory();
+                       } });
+        runner.run("bitarray/for_each_set", 4096, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           int sum = 0;
+                           bits.forEachSet([&sum](int index) { sum += index; });
+                           doNotOptimize(sum);
+                       } });
+    }
+
+    void benchConcurrency(bench::Runner &runner)
+    {
+        static fenz::BlockingQueue<int, 1024> blocking;
+        runner.run("blocking_queue/uncontended", 1024, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           blocking.enqueue(static_cast<int>(i));
+                           doNotOptimize(blocking.dequeue());
+                       } });
+
+        static fenz::Scheduler<1> scheduler;
+        runner.run("scheduler/spawn_wait", 1, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           auto task = fenz::makeTask([i]() { return i; });
+                           scheduler.spawn(task);
+                           scheduler.wait(task);
+                           doNotOptimize(task.result());
+                       } });
+    }
+
+    void benchStatistics(bench::Runner &runner)
+    {
+        static fenz::LatencyHistogram<> histogram;
+        runner.run("histogram/record", 0, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           histogram.record(fenz::Nanoseconds::fromNanos(i & 0xFFFFF));
+                       } });
+
+        static fenz::TokenBucket<fenz::NanoMoment> bucket(1000000000ULL, fenz::Nanoseconds::fromMillis(1000), 1000000, fenz::NanoMoment::fromTicks(0));
+        runner.run("rate_limit/token_bucket", 0, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(bucket.tryAcquire(1, fenz::NanoMoment::fromTicks(i)));
+                       } });
+
+        static fenz::SlidingWindowCounter<16> counter(fenz::Duration::fromMillis(100), fenz::Moment::fromTicks(0));
+        runner.run("window/counter_add", 16, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           counter.add(fenz::Moment::fromTicks(i >> 10));
+                       }
+                       doNotOptimize(counter.count(fenz::Moment::fromTicks(iterations >> 10))); });
+
+        runner.run("profiler/zone", 0, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           FENZ_ZONE("bench");
+                       }
+                       fenz::collectZoneEvents([](const fenz::ZoneEvent &) {}); });
+    }
+    fenz::Scheduler<4> &benchScheduler()
+    {
+        static fenz::Scheduler<4> scheduler;
+        return scheduler;
+    }
+
+    /// Sorts copies of N random keys. Times are per element.
+    template <int N>
+    void benchSort(bench::Runner &runner)
+    {
+        static std::vector<unsigned int> keys(N);
+        static fenz::Array<unsigned int, N> items(0);
+        static fenz::Array<unsigned int, N> scratch(0);
+        Random random = {N * 13};
+        for (int i = 0; i < N; ++i)
+        {
+            keys[i] = random.next();
+        }
+
+        runner.run("sort/fenz_sort", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           std::copy(keys.begin(), keys.end(), items.begin());
+                           fenz::sort(items);
+                           doNotOptimize(items.begin()[0]);
+                       } }, N);
+        runner.run("sort/fenz_sort_parallel", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           std::copy(keys.begin(), keys.end(), items.begin());
+                           fenz::sort(items, benchScheduler());
+                           doNotOptimize(items.begin()[0]);
+                       } }, N);
+        runner.run("sort/fenz_stable_sort", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           std::copy(keys.begin(), keys.end(), items.begin());
+                           fenz::stableSort(items, scratch);
+                           doNotOptimize(items.begin()[0]);
+                       } }, N);
+        runner.run("sort/fenz_radix_sort", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           std::copy(keys.begin(), keys.end(), items.begin());
+                           fenz::radixSort(items, scratch);
+                           doNotOptimize(items.begin()[0]);
+                       } }, N);
+        runner.run("sort/fenz_nth_element", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           std::copy(keys.begin(), keys.end(), items.begin());
+                           fenz::nthElement(items, N / 2);
+                           doNotOptimize(items.begin()[N / 2]);
+                       } }, N);
+        runner.run("sort/std_sort", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           std::copy(keys.begin(), keys.end(), items.begin());
+                           std::sort(items.begin(), items.end());
+                           doNotOptimize(items.begin()[0]);
+                       } }, N);
+        runner.run("sort/std_stable_sort", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           std::copy(keys.begin(), keys.end(), items.begin());
+                           std::stable_sort(items.begin(), items.end());
+                           doNotOptimize(items.begin()[0]);
+                       } }, N);
+    }
+
+    /// Sorts, and takes the median of, N random keys with sorting networks. Times are per array.
+    template <int N>
+    void benchNetworks(bench::Runner &runner)
+    {
+        static unsigned int keys[1024][N];
+        Random random = {N * 17};
+        for (int i = 0; i < 1024; ++i)
+        {
+            for (int j = 0; j < N; ++j)
+            {
+                keys[i][j] = random.next();
+            }
+        }
+
+        runner.run("network/fenz_sort_network", N, [](long long iterations)
+                   {
+                       fenz::Array<unsigned int, N> items(0);
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           std::copy(keys[i & 1023], keys[i & 1023] + N, items.begin());
+                           fenz::sortNetwork(items);
+                           doNotOptimize(items.begin()[0]);
+                       } });
+        runner.run("network/std_sort", N, [](long long iterations)
+                   {
+                       fenz::Array<unsigned int, N> items(0);
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           std::copy(keys[i & 1023], keys[i & 1023] + N, items.begin());
+                           std::sort(items.begin(), items.end());
+                           doNotOptimize(items.begin()[0]);
+                       } });
+        runner.run("network/fenz_median", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           fenz::Iterable<unsigned int, N> items(keys[i & 1023]);
+                           doNotOptimize(fenz::median(items));
+                       } });
+        runner.run("network/std_nth_element", N, [](long long iterations)
+                   {
+                       unsigned int items[N];
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           std::copy(keys[i & 1023], keys[i & 1023] + N, items);
+                           std::nth_element(items, items + N / 2, items + N);
+                           doNotOptimize(items[N / 2]);
+                       } });
+        runner.run("network/fenz_top_4", N, [](long long iterations)
+                   {
+                       fenz::Array<unsigned int, N> items(0);
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           std::copy(keys[i & 1023], keys[i & 1023] + N, items.begin());
+                           fenz::topK<4>(items);
+                           doNotOptimize(items.begin()[3]);
+                       } });
+    }
+
+    /// Prefix sums of N values. Times are per element.
+    template <int N>
+    void benchScan(bench::Runner &runner)
+    {
+        static fenz::Array<int, N> integers(1);
+        static fenz::Array<float, N> floats(0.5f);
+        static fenz::Array<int, N> integerSums(0);
+        static fenz::Array<float, N> floatSums(0.0f);
+
+        runner.run("scan/fenz_inclusive_int", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           fenz::inclusiveScan(integers, integerSums);
+                           doNotOptimize(integerSums.begin()[N - 1]);
+                       } }, N);
+        runner.run("scan/fenz_inclusive_int_parallel", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           fenz::inclusiveScan(integers, integerSums, benchScheduler());
+                           doNotOptimize(integerSums.begin()[N - 1]);
+                       } }, N);
+        runner.run("scan/std_partial_sum_int", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           std::partial_sum(integers.begin(), integers.end(), integerSums.begin());
+                           doNotOptimize(integerSums.begin()[N - 1]);
+                       } }, N);
+        runner.run("scan/fenz_inclusive_float", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           fenz::inclusiveScan(floats, floatSums);
+                           doNotOptimize(floatSums.begin()[N - 1]);
+                       } }, N);
+        runner.run("scan/std_partial_sum_float", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           std::partial_sum(floats.begin(), floats.end(), floatSums.begin());
+                           doNotOptimize(floatSums.begin()[N - 1]);
+                       } }, N);
+        runner.run("scan/fenz_running_max_int", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           fenz::inclusiveScan(integers, integerSums, fenz::Max<int>());
+                           doNotOptimize(integerSums.begin()[N - 1]);
+                       } }, N);
+    }
+
+    /// Linear searches of N sorted integers, timed per element, and binary searches, timed per query.
+    template <int N>
+    void benchSearch(bench::Runner &runner)
+    {
+        enum
+        {
+            Queries = 1024
+        };
+        static fenz::Array<int, N> sorted(0);
+        static fenz::Array<int, Queries> queries(0);
+        for (int i = 0; i < N; ++i)
+        {
+            sorted.begin()[i] = 2 * i;
+        }
+        Random random = {N * 17};
+        for (int i = 0; i < Queries; ++i)
+        {
+            queries.begin()[i] = static_cast<int>(random.next() % (2 * N));
+        }
+
+        // The last element is the worst case for a linear search
+        runner.run("search/fenz_find", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           doNotOptimize(fenz::find(sorted, 2 * (N - 1)).valueOr(-1));
+                       } }, N);
+        runner.run("search/std_find", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           doNotOptimize(std::find(sorted.begin(), sorted.end(), 2 * (N - 1)));
+                       } }, N);
+        runner.run("search/fenz_count", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           doNotOptimize(fenz::count(sorted, 2));
+                       } }, N);
+        runner.run("search/std_count", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           doNotOptimize(std::count(sorted.begin(), sorted.end(), 2));
+                       } }, N);
+        runner.run("search/fenz_lower_bound", 1, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(fenz::lowerBound(sorted, queries.begin()[i % Queries]));
+                       } });
+        runner.run("search/std_lower_bound", 1, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(std::lower_bound(sorted.begin(), sorted.end(), queries.begin()[i % Queries]));
+                       } });
+    }
+
+    /// Lookups of random present keys in a table of N sorted keys. Times are per lookup.
+    template <int N>
+    void benchSearchTable(bench::Runner &runner)
+    {
+        enum
+        {
+            Queries = 4096
+        };
+        static fenz::Array<int, N> keys(0);
+        static fenz::Array<int, N> values(0);
+        static fenz::Array<int, Queries> queries(0);
+        for (int i = 0; i < N; ++i)
+        {
+            keys.begin()[i] = 2 * i;
+            values.begin()[i] = i;
+        }
+        Random random = {N * 19};
+        for (int i = 0; i < Queries; ++i)
+        {
+            queries.begin()[i] = static_cast<int>(random.next() % N) * 2;
+        }
+        static fenz::StaticSearchTable<int, int, N> table(keys, values);
+
+        runner.run("table/fenz_static_search_table", N, [](long long iterations)
+                   {
+                       int missing = -1;
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(table.find(queries.begin()[i % Queries]).valueOr(missing));
+                       } });
+        runner.run("table/fenz_lower_bound", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(fenz::lowerBound(keys, queries.begin()[i % Queries]));
+                       } });
+        runner.run("table/std_lower_bound", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(std::lower_bound(keys.begin(), keys.end(), queries.begin()[i % Queries]));
+                       } });
+    }
+
+    /// Checksums and hashes of N bytes. Times are per byte.
+    template <int N>
+    void benchHash(bench::Runner &runner)
+    {
+        static fenz::Array<unsigned char, N> bytes(0);
+        Random random = {N * 23};
+        for (int i = 0; i < N; ++i)
+        {
+            bytes.begin()[i] = static_cast<unsigned char>(random.next());
+        }
+        static const std::string text(reinterpret_cast<const char *>(bytes.begin()), N);
+
+        runner.run("hash/fenz_crc32c", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           doNotOptimize(fenz::crc32c(bytes));
+                       } }, N);
+        runner.run("hash/fenz_hash64", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           doNotOptimize(fenz::hash64(bytes));
+                       } }, N);
+        runner.run("hash/std_hash_string", N, [](long long iterations)
+                   {
+                       std::hash<std::string> hasher;
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           doNotOptimize(hasher(text));
+                       } }, N);
+    }
+
+    /// Opening a file of N integers by mapping it, against reading it into an Array. The sums are timed per element.
+    template <int N>
+    void benchMapped(bench::Runner &runner)
+    {
+        static const char *path = "fenz_bench_mapped.bin";
+        static fenz::Array<int, N> buffer(1);
+        FILE *file = std::fopen(path, "wb");
+        if (file == nullptr || std::fwrite(buffer.begin(), sizeof(int), N, file) != static_cast<size_t>(N))
+        {
+            std::fprintf(stderr, "Skipping mapped benchmarks: cannot write %s\n", path);
+            if (file != nullptr)
+            {
+                std::fclose(file);
+            }
+            return;
+        }
+        std::fclose(file);
+
+        runner.run("mapped/fenz_open", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           doNotOptimize(fenz::MappedIterable<const int, N>::open(path).hasValue());
+                       } });
+        runner.run("mapped/fenz_open_and_sum", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           fenz::Option<fenz::MappedIterable<const int, N>> mapped = fenz::MappedIterable<const int, N>::open(path);
+                           long long sum = 0;
+                           for (int value : mapped.value_unsafely())
+                           {
+                               sum += value;
+                           }
+                           doNotOptimize(sum);
+                       } }, N);
+        runner.run("mapped/fread_and_sum", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           FILE *input = std::fopen(path, "rb");
+                           doNotOptimize(std::fread(buffer.begin(), sizeof(int), N, input));
+                           std::fclose(input);
+                           long long sum = 0;
+                           for (int value : buffer)
+                           {
+                               sum += value;
+                           }
+                           doNotOptimize(sum);
+                       } }, N);
+        std::remove(path);
+    }
+
+    struct SerialRecord
+    {
+        long long id;
+        double price;
+    };
+
+    /// The same record, serialized field by field.
+    struct SerialFieldRecord
+    {
+        long long id;
+        double price;
+
+        template <typename Self, typename Visitor>
+        static void fields(Self &self, Visitor &visit)
+        {
+            visit(self.id, self.price);
+        }
+    };
+
+    /// Snapshotting N records and reading them back, with one bulk copy, field by field, and as a view in place.
+    /// Times are per record.
+    template <int N>
+    void benchSerialize(bench::Runner &runner)
+    {
+        static fenz::Array<SerialRecord, N> records{SerialRecord{0, 0}};
+        static fenz::Array<SerialFieldRecord, N> fieldRecords{SerialFieldRecord{0, 0}};
+        static fenz::Array<long long, N> durationTicks(0);
+        alignas(64) static unsigned char buffer[N * sizeof(SerialRecord) * 2 + 64];
+        static const fenz::Span<unsigned char> bytes(buffer, sizeof(buffer));
+        Random random = {N * 29};
+        for (int i = 0; i < N; ++i)
+        {
+            records.begin()[i] = SerialRecord{static_cast<long long>(random.next()), static_cast<double>(i)};
+            fieldRecords.begin()[i] = SerialFieldRecord{records.begin()[i].id, records.begin()[i].price};
+            durationTicks.begin()[i] = static_cast<long long>(random.next() % 2000) - 1000;
+        }
+
+        runner.run("serialize/fenz_write_bulk", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           fenz::BinaryWriter writer(bytes);
+                           writer.write(records);
+                           doNotOptimize(writer.finish().valueOr(0));
+                       } }, N);
+        runner.run("serialize/fenz_write_fields", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           fenz::BinaryWriter writer(bytes);
+                           writer.write(fieldRecords);
+                           doNotOptimize(writer.finish().valueOr(0));
+                       } }, N);
+        runner.run("serialize/fenz_write_duration_varints", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           fenz::BinaryWriter writer(bytes);
+                           for (long long ticks : durationTicks)
+                           {
+                               writer.write(fenz::Duration::fromTicks(ticks));
+                           }
+                           doNotOptimize(writer.finish().valueOr(0));
+                       } }, N);
+
+        fenz::BinaryWriter writer(bytes);
+        writer.write(records);
+        static const int size = writer.finish().valueOr(0);
+        runner.run("serialize/fenz_read_copy", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           fenz::Option<fenz::BinaryReader> reader = fenz::BinaryReader::open(fenz::Span<const unsigned char>(buffer, size));
+                           doNotOptimize(reader.value_unsafely().read(records));
+                       } }, N);
+        runner.run("serialize/fenz_read_view", N, [](long long iterations)
+                   {
+                       for (long long i = 0; i < iterations; i += N)
+                       {
+                           fenz::Option<fenz::BinaryReader> reader = fenz::BinaryReader::open(fenz::Span<const unsigned char>(buffer, size));
+                           doNotOptimize(reader.value_unsafely().view<SerialRecord, N>().value_unsafely().template at<N - 1>().id);
+                       } }, N);
+    }
+
+    /// Enqueueing and dequeueing through shared memory queues, in one process. Times are per item.
+    void benchShmQueue(bench::Runner &runner)
+    {
+        struct Frame
+        {
+            long long sequence;
+            char payload[56];
+        };
+        typedef fenz::ShmQueue<Frame, 1024> WakingQueue;
+        typedef fenz::ShmQueue<Frame, 1024, false> PollingQueue;
+        static const char *wakingName = "/fenz-bench-waking";
+        static const char *pollingName = "/fenz-bench-polling";
+        WakingQueue::remove(wakingName);
+        PollingQueue::remove(pollingName);
+        static fenz::Option<WakingQueue> waking = WakingQueue::create(wakingName);
+        static fenz::Option<PollingQueue> polling = PollingQueue::create(pollingName);
+        if (!waking || !polling)
+        {
+            std::fprintf(stderr, "Skipping shared memory benchmarks: cannot create queues\n");
+            return;
+        }
+
+        runner.run("shm_queue/waking", 1, [](long long iterations)
+                   {
+                       WakingQueue &queue = waking.value_unsafely();
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           queue.enqueueWith([i](Frame &frame) { frame.sequence = i; });
+                           queue.dequeueWith([](const Frame &frame) { doNotOptimize(frame.sequence); });
+                       } });
+        runner.run("shm_queue/polling", 1, [](long long iterations)
+                   {
+                       PollingQueue &queue = polling.value_unsafely();
+                       for (long long i = 0; i < iterations; ++i)
+                       {
+                           queue.enqueueWith([i](Frame &frame) { frame.sequence = i; });
+                           queue.dequeueWith([](const Frame &frame) { doNotOptimize(frame.sequence); });
+                       } });
+        runner.run("shm_queue/polling_batch_64", 64, [](long long iterations)
+                   {
+                       PollingQueue &queue = polling.value_unsafely();
+                       for (long long i = 0; i < iterations; i += 64)
+                       {
+                           for (int j = 0; j < 64; ++j)
+                           {
+                               queue.enqueueWith([i](Frame &frame) { frame.sequence = i; });
+                           }
+                           for (int j = 0; j < 64; ++j)
+                           {
+                               queue.dequeueWith([](const Frame &frame) { doNotOptimize(frame.sequence); });
+                           }
+                       } }, 64);
+        WakingQueue::remove(wakingName);
+        PollingQueue::remove(pollingName);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bench::Config config = {3, 15, fenz::Nanoseconds::fromMillis(20), argc > 1 ? argv[1] : nullptr};
+    bench::Runner runner(stdout, config);
+
+    benchQueue(runner);
+    benchDeque(runner);
+    benchOption(runner);
+    benchIteration<16>(runner);
+    benchIteration<1024>(runner);
+    benchIteration<65536>(runner);
+    benchTime(runner);
+    benchPriorityQueue<1024>(runner);
+    benchPriorityQueue<65536>(runner);
+    benchPriorityQueue<1048576>(runner);
+    benchTimers<1024>(runner);
+    benchTimers<65536>(runner);
+    benchBitArray(runner);
+    benchConcurrency(runner);
+    benchStatistics(runner);
+    benchSort<16>(runner);
+    benchSort<1024>(runner);
+    benchSort<65536>(runner);
+    benchNetworks<9>(runner);
+    benchNetworks<16>(runner);
+    benchNetworks<32>(runner);
+    benchScan<1024>(runner);
+    benchScan<1048576>(runner);
+    benchSearch<64>(runner);
+    benchSearch<1048576>(runner);
+    benchSearchTable<4096>(runner);
+    benchSearchTable<4194304>(runner);
+    benchHash<64>(runner);
+    benchHash<65536>(runner);
+    benchMapped<4194304>(runner);
+    benchShmQueue(runner);
+    benchSerialize<4096>(runner);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+#include "../fenz/time.hpp"
+
+#ifndef FENZ_BENCH_HARNESS_HPP
+#define FENZ_BENCH_HARNESS_HPP
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace bench
+{
+    /// @brief Keeps the compiler from optimizing away the computation of a value.
+    template <typename T>
+    inline void doNotOptimize(const T &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /// @brief Keeps the compiler from caching memory contents in registers across this point.
+    inline void clobberMemory()
+    {
+        asm volatile("" : : : "memory");
+    }
+
+    /// @brief Settings shared by all benchmarks of a run.
+    struct Config
+    {
+        /// Repetitions run and discarded before measuring.
+        int warmup;
+        /// Repetitions measured.
+        int repetitions;
+        /// The minimum time one repetition should take. The iteration count is doubled until it does.
+        fenz::Nanoseconds minRepetitionTime;
+        /// Only benchmarks whose name contains this string are run. Null runs all.
+        const char *filter;
+    };
+
+    /// @brief Summary statistics of the per-operation times of all measured repetitions.
+    struct Result
+    {
+        double mean;
+        double median;
+        double min;
+        double max;
+        double stddev;
+        /// Half-width of the 95% confidence interval of the mean, using Student's t distribution.
+        double ci95;
+    };
+
+    namespace detail
+    {
+        /// @brief Returns the two-sided 95% quantile of Student's t distribution.
+        inline double studentT95(int degreesOfFreedom)
+        {
+            static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                           2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                           2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+            if (degreesOfFreedom < 1)
+            {
+                return 0.0;
+            }
+            return degreesOfFreedom <= 30 ? table[degreesOfFreedom - 1] : 1.960;
+        }
+
+        inline Result summarize(double *samples, int count)
+        {
+            // Insertion sort: there are only a few dozen samples
+            for (int i = 1; i < count; ++i)
+            {
+                double sample = samples[i];
+                int j = i;
+                for (; j > 0 && samples[j - 1] > sample; --j)
+                {
+                    samples[j] = samples[j - 1];
+                }
+                samples[j] = sample;
+            }
+
+            Result result;
+            double sum = 0.0;
+            for (int i = 0; i < count; ++i)
+            {
+                sum += samples[i];
+            }
+            result.mean = sum / count;
+            double squares = 0.0;
+            for (int i = 0; i < count; ++i)
+            {
+                squares += (samples[i] - result.mean) * (samples[i] - result.mean);
+            }
+            result.stddev = count > 1 ? std::sqrt(squares / (count - 1)) : 0.0;
+            result.ci95 = count > 1 ? studentT95(count - 1) * result.stddev / std::sqrt(static_cast<double>(count)) : 0.0;
+            result.median = count % 2 == 1 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2.0;
+            result.min = samples[0];
+            result.max = samples[count - 1];
+            return result;
+        }
+    }
+
+    /// @brief Runs benchmarks and writes their results as a JSON document.
+    /// @details Each benchmark is a function taking an iteration count and performing the measured operation that many
+    ///          times. The iteration count is calibrated so that one repetition takes at least `minRepetitionTime`, then
+    ///          `warmup` repetitions are discarded and `repetitions` are measured with `NanoMoment`.
+    class Runner
+    {
+    private:
+        static constexpr int MaxRepetitions = 1000;
+
+        FILE *out_;
+        Config config_;
+        bool first_;
+        double samples_[MaxRepetitions];
+
+        template <typename Func>
+        static fenz::Nanoseconds time(Func &func, long long iterations)
+        {
+            fenz::NanoMoment start = fenz::NanoMoment::now();
+            func(iterations);
+            clobberMemory();
+            return fenz::NanoMoment::now() - start;
+        }
+
+    public:
+        /// @brief Starts the JSON document.
+        /// @param out The file to write results to. Progress is written to stderr.
+        /// @param config Settings for all benchmarks.
+        Runner(FILE *out, const Config &config) : out_(out), config_(config), first_(true)
+        {
+            if (config_.repetitions > MaxRepetitions)
+            {
+                config_.repetitions = MaxRepetitions;
+            }
+            if (config_.repetitions < 1)
+            {
+                config_.repetitions = 1;
+            }
+            std::fprintf(out_, "{\n  \"warmup\": %d,\n  \"repetitions\": %d,\n  \"min_repetition_ns\": %lld,\n  \"benchmarks\": [",
+                         config_.warmup, config_.repetitions, config_.minRepetitionTime.nanos());
+        }
+
+        /// @brief Finishes the JSON document.
+        ~Runner()
+        {
+            std::fprintf(out_, "\n  ]\n}\n");
+            std::fflush(out_);
+        }
+
+        Runner(const Runner &) = delete;
+        Runner &operator=(const Runner &) = delete;
+
+        /// @brief Runs one benchmark, unless it is excluded by the filter.
+        /// @param name The name of the benchmark, e.g. "queue/enqueue_dequeue".
+        /// @param param A size or other parameter the benchmark was run with, reported alongside the name.
+        /// @param func The function to measure. This function should take a single `long long` iteration count.
+        /// @param batch The number of operations `func` performs per pass of its loop. Pass it for every function that
+        ///        steps its iteration count by more than one, e.g. `i += N` over a container of `N` elements. Timing
+        ///        starts from one batch, so that a batch that alone takes longer than a repetition is still divided
+        ///        by the operations it performed, rather than by 1.
+        template <typename Func>
+        void run(const char *name, long long param, Func func, long long batch = 1)
+        {
+            if (config_.filter != nullptr && std::strstr(name, config_.filter) == nullptr)
+            {
+                return;
+            }
+
+            long long iterations = batch;
+            while (time(func, iterations) < config_.minRepetitionTime && iterations < (1LL << 40))
+            {
+                iterations *= 2;
+            }
+            for (int i = 0; i < config_.warmup; ++i)
+            {
+                time(func, iterations);
+            }
+            for (int i = 0; i < config_.repetitions; ++i)
+            {
+                samples_[i] = static_cast<double>(time(func, iterations).nanos()) / static_cast<double>(iterations);
+            }
+            Result result = detail::summarize(samples_, config_.repetitions);
+
+            std::fprintf(out_, "%s\n    {\"name\": \"%s\", \"param\": %lld, \"iterations\": %lld, "
+                               "\"mean_ns\": %.4f, \"median_ns\": %.4f, \"min_ns\": %.4f, \"max_ns\": %.4f, "
+                               "\"stddev_ns\": %.4f, \"ci95_low_ns\": %.4f, \"ci95_high_ns\": %.4f}",
+                         first_ ? "" : ",", name, param, iterations,
+                         result.mean, result.median, result.min, result.max,
+                         result.stddev, result.mean - result.ci95, result.mean + result.ci95);
+            first_ = false;
+            std::fprintf(stderr, "%-40s %10lld %12.3f ns/op  +- %.3f\n", name, param, result.mean, result.ci95);
+        }
+    };
+}
+
+#endif // FENZ_BENCH_HARNESS_HPP
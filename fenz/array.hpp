@@ -109,6 +109,62 @@ namespace fenz
         Array &operator=(const Array &) = delete;
     };
 
+    /// @brief A non-owning view of a portion of an array whose size is only known at runtime.
+    /// @details Used where the length of a contiguous region depends on runtime state,
+    ///          such as the halves of a ring buffer. Prefer `Iterable` when the size is known at compile time.
+    /// @tparam T Type of the elements in the span.
+    template <typename T>
+    class Span
+    {
+    private:
+        // A pointer to the first element of the span.
+        T *data_;
+        // The number of elements in the span.
+        int size_;
+
+    public:
+        /// @brief Constructs an empty Span.
+        Span();
+
+        /// @brief Constructs a Span from a pointer to data and a number of elements.
+        /// @param data Pointer to the data.
+        /// @param size Number of elements in the span.
+        /// @warning It is assumed that the data pointer points to an array of at least `size` elements.
+        Span(T *data, int size);
+
+        /// @brief Constructs a Span covering all elements of an Iterable.
+        /// @param iterable The Iterable to view.
+        template <int N>
+        Span(Iterable<T, N> &iterable);
+
+        /// @brief Constructs a read-only Span covering all elements of an Iterable.
+        /// @param iterable The Iterable to view.
+        /// @note Only usable when `T` is const.
+        template <typename U, int N>
+        Span(const Iterable<U, N> &iterable);
+
+        /// @brief Returns the number of elements in the span.
+        /// @return The number of elements in the span.
+        int size() const { return size_; }
+
+        /// @brief Checks if the span has no elements.
+        /// @return True if the span is empty.
+        bool isEmpty() const { return size_ == 0; }
+
+        /// @brief Returns a pointer to the first element of the span.
+        /// @return Pointer to the first element.
+        T *data() const { return data_; }
+
+        /// @brief Performs an operation on each element of the span.
+        /// @param func A callable that is the operation to perform on each element. The parameters to the function are `(T&, int)` — the element and its index.
+        template <typename Func>
+        void enumerate(Func func) const;
+
+        // Range-based for support
+        T *begin() const { return data_; }
+        T *end() const { return data_ + size_; }
+    };
+
     // =======================================
     //  Implementations only below this point
     // =======================================
@@ -203,6 +259,38 @@ namespace fenz
             ownedData_[i] = defaultValue;
         }
     }
+
+    template <typename T>
+    inline Span<T>::Span() : data_(nullptr), size_(0)
+    {
+    }
+
+    template <typename T>
+    inline Span<T>::Span(T *data, int size) : data_(data), size_(size)
+    {
+    }
+
+    template <typename T>
+    template <int N>
+    inline Span<T>::Span(Iterable<T, N> &iterable) : data_(iterable.begin()), size_(N)
+    {
+    }
+
+    template <typename T>
+    template <typename U, int N>
+    inline Span<T>::Span(const Iterable<U, N> &iterable) : data_(iterable.begin()), size_(N)
+    {
+    }
+
+    template <typename T>
+    template <typename Func>
+    inline void Span<T>::enumerate(Func func) const
+    {
+        for (int i = 0; i < size_; ++i)
+        {
+            func(data_[i], i);
+        }
+    }
 }
 
 #endif // FENZ_ARRAY_HPP
@@ -0,0 +1,457 @@
+#include "option.hpp"
+
+#ifndef FENZ_BITARRAY_HPP
+#define FENZ_BITARRAY_HPP
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace fenz
+{
+    namespace detail
+    {
+        /// @brief Returns the number of set bits in a word.
+        inline int popcount64(unsigned long long word)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_popcountll(word);
+#else
+            int count = 0;
+            while (word != 0)
+            {
+                word &= word - 1;
+                ++count;
+            }
+            return count;
+#endif
+        }
+
+        /// @brief Returns the index of the lowest set bit in a word.
+        /// @note Calling this with a word of zero results in undefined behavior.
+        inline int countTrailingZeros64(unsigned long long word)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctzll(word);
+#else
+            int index = 0;
+            while ((word & 1ULL) == 0)
+            {
+                word >>= 1;
+                ++index;
+            }
+            return index;
+#endif
+        }
+
+        /// @brief Returns the number of zero bits above the highest set bit in a word.
+        /// @note Calling this with a word of zero results in undefined behavior.
+        inline int countLeadingZeros64(unsigned long long word)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_clzll(word);
+#else
+            int count = 0;
+            while ((word & (1ULL << 63)) == 0)
+            {
+                word <<= 1;
+                ++count;
+            }
+            return count;
+#endif
+        }
+    }
+
+    /// @brief A fixed-size array of bits, packed 64 to a word.
+    /// @details Uses one bit per flag instead of one byte like `Array<bool, N>`, and scans a whole word at a time
+    ///          when counting or searching for set or clear bits.
+    /// @tparam N Number of bits in the array.
+    template <int N>
+    class BitArray
+    {
+        static_assert(N > 0, "BitArray size must be greater than zero");
+
+    private:
+        /// Number of 64-bit words used to store the bits.
+        static constexpr int Words = (N + 63) / 64;
+
+        /// Mask of the bits in the last word that belong to the array.
+        static constexpr unsigned long long LastWordMask = (N % 64 == 0) ? ~0ULL : ((1ULL << (N % 64)) - 1ULL);
+
+        /// @brief The packed bits. Bits past `N` in the last word are always zero.
+        unsigned long long words_[Words];
+
+    public:
+        /// @brief Constructs a BitArray with all bits cleared.
+        BitArray();
+
+        /// @brief Constructs a BitArray with all bits set to a default value.
+        /// @param defaultValue The value to initialize all bits of the array to.
+        BitArray(bool defaultValue);
+
+        /// @brief Returns the value of the bit at the specified index.
+        /// @tparam i Index of the bit to read.
+        /// @return True if the bit is set.
+        template <int i>
+        bool test() const;
+
+        /// @brief Sets the bit at the specified index to a value.
+        /// @tparam i Index of the bit to write.
+        /// @param value The value to write, set by default.
+        template <int i>
+        void set(bool value = true);
+
+        /// @brief Clears the bit at the specified index.
+        /// @tparam i Index of the bit to clear.
+        template <int i>
+        void reset();
+
+        /// @brief Returns the value of the bit at the specified index.
+        /// @param index Index of the bit to read.
+        /// @return An Option containing the value of the bit, or an empty Option if the index is out of bounds.
+        Option<bool> test(int index) const;
+
+        /// @brief Sets the bit at the specified index to a value.
+        /// @param index Index of the bit to write.
+        /// @param value The value to write, set by default.
+        /// @return True if the bit was written, false if the index is out of bounds.
+        bool set(int index, bool value = true);
+
+        /// @brief Clears the bit at the specified index.
+        /// @param index Index of the bit to clear.
+        /// @return True if the bit was cleared, false if the index is out of bounds.
+        bool reset(int index);
+
+        /// @brief Sets all bits.
+        void setAll();
+
+        /// @brief Clears all bits.
+        void resetAll();
+
+        /// @brief Inverts all bits.
+        void flipAll();
+
+        /// @brief Returns the number of set bits.
+        /// @return The number of set bits.
+        int count() const;
+
+        /// @brief Returns the number of bits in the array.
+        /// @return The number of bits in the array.
+        constexpr int size() const
+        {
+            return N;
+        }
+
+        /// @brief Checks if any bit is set.
+        /// @return True if at least one bit is set.
+        bool any() const;
+
+        /// @brief Checks if no bit is set.
+        /// @return True if all bits are cleared.
+        bool none() const;
+
+        /// @brief Checks if every bit is set.
+        /// @return True if all bits are set.
+        bool all() const;
+
+        /// @brief Finds the lowest index of a set bit.
+        /// @return An Option containing the index of the first set bit, or an empty Option if no bit is set.
+        Option<int> findFirstSet() const;
+
+        /// @brief Finds the lowest index of a cleared bit.
+        /// @return An Option containing the index of the first cleared bit, or an empty Option if all bits are set.
+        Option<int> findFirstClear() const;
+
+        /// @brief Calls a function for the index of every set bit, in ascending order.
+        /// @param func A callable taking `(int)` — the index of a set bit.
+        /// @note Only the set bits are visited, so sparse arrays are cheap to iterate.
+        template <typename Func>
+        void forEachSet(Func func) const;
+
+        /// @brief Keeps only the bits that are set in both this and `other`.
+        /// @param other The BitArray to combine with.
+        /// @return Reference to this BitArray.
+        BitArray &operator&=(const BitArray &other);
+
+        /// @brief Sets the bits that are set in either this or `other`.
+        /// @param other The BitArray to combine with.
+        /// @return Reference to this BitArray.
+        BitArray &operator|=(const BitArray &other);
+
+        /// @brief Sets the bits that are set in exactly one of this and `other`.
+        /// @param other The BitArray to combine with.
+        /// @return Reference to this BitArray.
+        BitArray &operator^=(const BitArray &other);
+
+        /// @brief Checks if two BitArrays have the same bits set.
+        /// @param other The BitArray to compare with.
+        /// @return True if all bits are equal.
+        bool operator==(const BitArray &other) const;
+
+    private:
+        /// @brief Applies a bitwise operation word by word, four words at a time with AVX2 when available.
+        template <typename ScalarOp, typename VectorOp>
+        void combine(const BitArray &other, ScalarOp scalarOp, VectorOp vectorOp);
+    };
+
+    // =======================================
+    //  Implementations only below this point
+    // =======================================
+
+    template <int N>
+    constexpr int BitArray<N>::Words;
+
+    template <int N>
+    constexpr unsigned long long BitArray<N>::LastWordMask;
+
+    template <int N>
+    inline BitArray<N>::BitArray()
+    {
+        resetAll();
+    }
+
+    template <int N>
+    inline BitArray<N>::BitArray(bool defaultValue)
+    {
+        if (defaultValue)
+        {
+            setAll();
+        }
+        else
+        {
+            resetAll();
+        }
+    }
+
+    template <int N>
+    template <int i>
+    inline bool BitArray<N>::test() const
+    {
+        static_assert(i >= 0 && i < N, "Index out of bounds");
+        return (words_[i / 64] >> (i % 64)) & 1ULL;
+    }
+
+    template <int N>
+    template <int i>
+    inline void BitArray<N>::set(bool value)
+    {
+        static_assert(i >= 0 && i < N, "Index out of bounds");
+        const unsigned long long bit = 1ULL << (i % 64);
+        words_[i / 64] = value ? (words_[i / 64] | bit) : (words_[i / 64] & ~bit);
+    }
+
+    template <int N>
+    template <int i>
+    inline void BitArray<N>::reset()
+    {
+        set<i>(false);
+    }
+
+    template <int N>
+    inline Option<bool> BitArray<N>::test(int index) const
+    {
+        if (index < 0 || index >= N)
+        {
+            return Option<bool>();
+        }
+        return Option<bool>(((words_[index / 64] >> (index % 64)) & 1ULL) != 0);
+    }
+
+    template <int N>
+    inline bool BitArray<N>::set(int index, bool value)
+    {
+        if (index < 0 || index >= N)
+        {
+            return false;
+        }
+        const unsigned long long bit = 1ULL << (index % 64);
+        words_[index / 64] = value ? (words_[index / 64] | bit) : (words_[index / 64] & ~bit);
+        return true;
+    }
+
+    template <int N>
+    inline bool BitArray<N>::reset(int index)
+    {
+        return set(index, false);
+    }
+
+    template <int N>
+    inline void BitArray<N>::setAll()
+    {
+        for (int w = 0; w < Words; ++w)
+        {
+            words_[w] = ~0ULL;
+        }
+        words_[Words - 1] &= LastWordMask;
+    }
+
+    template <int N>
+    inline void BitArray<N>::resetAll()
+    {
+        for (int w = 0; w < Words; ++w)
+        {
+            words_[w] = 0ULL;
+        }
+    }
+
+    template <int N>
+    inline void BitArray<N>::flipAll()
+    {
+        for (int w = 0; w < Words; ++w)
+        {
+            words_[w] = ~words_[w];
+        }
+        words_[Words - 1] &= LastWordMask;
+    }
+
+    template <int N>
+    inline int BitArray<N>::count() const
+    {
+        int total = 0;
+        for (int w = 0; w < Words; ++w)
+        {
+            total += detail::popcount64(words_[w]);
+        }
+        return total;
+    }
+
+    template <int N>
+    inline bool BitArray<N>::any() const
+    {
+        for (int w = 0; w < Words; ++w)
+        {
+            if (words_[w] != 0ULL)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <int N>
+    inline bool BitArray<N>::none() const
+    {
+        return !any();
+    }
+
+    template <int N>
+    inline bool BitArray<N>::all() const
+    {
+        for (int w = 0; w < Words - 1; ++w)
+        {
+            if (words_[w] != ~0ULL)
+            {
+                return false;
+            }
+        }
+        return words_[Words - 1] == LastWordMask;
+    }
+
+    template <int N>
+    inline Option<int> BitArray<N>::findFirstSet() const
+    {
+        for (int w = 0; w < Words; ++w)
+        {
+            if (words_[w] != 0ULL)
+            {
+                return Option<int>(w * 64 + detail::countTrailingZeros64(words_[w]));
+            }
+        }
+        return Option<int>();
+    }
+
+    template <int N>
+    inline Option<int> BitArray<N>::findFirstClear() const
+    {
+        for (int w = 0; w < Words; ++w)
+        {
+            const unsigned long long valid = (w == Words - 1) ? LastWordMask : ~0ULL;
+            const unsigned long long clear = ~words_[w] & valid;
+            if (clear != 0ULL)
+            {
+                return Option<int>(w * 64 + detail::countTrailingZeros64(clear));
+            }
+        }
+        return Option<int>();
+    }
+
+    template <int N>
+    template <typename Func>
+    inline void BitArray<N>::forEachSet(Func func) const
+    {
+        for (int w = 0; w < Words; ++w)
+        {
+            unsigned long long word = words_[w];
+            while (word != 0ULL)
+            {
+                func(w * 64 + detail::countTrailingZeros64(word));
+                word &= word - 1; // Clear the lowest set bit
+            }
+        }
+    }
+
+    template <int N>
+    template <typename ScalarOp, typename VectorOp>
+    inline void BitArray<N>::combine(const BitArray &other, ScalarOp scalarOp, VectorOp vectorOp)
+    {
+        int w = 0;
+#if defined(__AVX2__)
+        for (; w + 4 <= Words; w += 4)
+        {
+            __m256i lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words_ + w));
+            __m256i rhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(other.words_ + w));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(words_ + w), vectorOp(lhs, rhs));
+        }
+#else
+        (void)vectorOp;
+#endif
+        for (; w < Words; ++w)
+        {
+            words_[w] = scalarOp(words_[w], other.words_[w]);
+        }
+    }
+
+#if defined(__AVX2__)
+#define FENZ_BITARRAY_VECTOR_OP(intrinsic) [](__m256i a, __m256i b) { return intrinsic(a, b); }
+#else
+#define FENZ_BITARRAY_VECTOR_OP(intrinsic) 0
+#endif
+
+    template <int N>
+    inline BitArray<N> &BitArray<N>::operator&=(const BitArray &other)
+    {
+        combine(other, [](unsigned long long a, unsigned long long b) { return a & b; }, FENZ_BITARRAY_VECTOR_OP(_mm256_and_si256));
+        return *this;
+    }
+
+    template <int N>
+    inline BitArray<N> &BitArray<N>::operator|=(const BitArray &other)
+    {
+        combine(other, [](unsigned long long a, unsigned long long b) { return a | b; }, FENZ_BITARRAY_VECTOR_OP(_mm256_or_si256));
+        return *this;
+    }
+
+    template <int N>
+    inline BitArray<N> &BitArray<N>::operator^=(const BitArray &other)
+    {
+        combine(other, [](unsigned long long a, unsigned long long b) { return a ^ b; }, FENZ_BITARRAY_VECTOR_OP(_mm256_xor_si256));
+        return *this;
+    }
+
+#undef FENZ_BITARRAY_VECTOR_OP
+
+    template <int N>
+    inline bool BitArray<N>::operator==(const BitArray &other) const
+    {
+        for (int w = 0; w < Words; ++w)
+        {
+            if (words_[w] != other.words_[w])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+#endif // FENZ_BITARRAY_HPP
@@ -0,0 +1,182 @@
+#include "futex.hpp"
+#include "option.hpp"
+#include "queue.hpp"
+#include "time.hpp"
+
+#ifndef FENZ_BLOCKING_QUEUE_HPP
+#define FENZ_BLOCKING_QUEUE_HPP
+
+#include <atomic>
+#include <mutex>
+
+namespace fenz
+{
+    /// @brief A thread-safe circular queue with a max capacity, where producers and consumers can wait for space or items.
+    /// @details Waiting threads spin briefly, then block on a futex. Producers and consumers only make a wake-up
+    ///          system call when another thread is actually blocked, so an idle queue costs no CPU.
+    /// @tparam T The type of elements in the queue.
+    /// @tparam Capacity The maximum number of elements the queue can hold.
+    /// @note Timeouts are measured with `Moment::now()`, so `fenzTimeSource` must be defined.
+    template <typename T, unsigned int Capacity>
+    class BlockingQueue
+    {
+    private:
+        /// The number of times a waiting thread polls the queue before blocking.
+        static constexpr int SpinCount = 128;
+
+        mutable std::mutex mutex_;
+        Queue<T, Capacity> queue_;
+
+        /// Incremented after every enqueue, consumers wait on it.
+        std::atomic<unsigned int> enqueued_;
+        /// Incremented after every dequeue, producers wait on it.
+        std::atomic<unsigned int> dequeued_;
+        /// The number of consumers blocked on `enqueued_`.
+        std::atomic<unsigned int> consumersWaiting_;
+        /// The number of producers blocked on `dequeued_`.
+        std::atomic<unsigned int> producersWaiting_;
+
+        /// @brief Calls `attempt` until it succeeds, blocking on `word` between attempts, or until the timeout passes.
+        template <typename Result, typename Attempt>
+        Result waitFor(Attempt attempt, std::atomic<unsigned int> &word, std::atomic<unsigned int> &waiting, Duration timeout)
+        {
+            for (int spin = 0; spin < SpinCount; ++spin)
+            {
+                Result result = attempt();
+                if (result)
+                {
+                    return result;
+                }
+                cpuRelax();
+            }
+
+            const Moment deadline = Moment::now() + timeout;
+            while (true)
+            {
+                unsigned int seen = word.load(std::memory_order_seq_cst);
+                Result result = attempt();
+                if (result)
+                {
+                    return result;
+                }
+
+                Duration remaining = deadline - Moment::now();
+                if (remaining <= Duration::fromMillis(0))
+                {
+                    return result;
+                }
+
+                waiting.fetch_add(1, std::memory_order_seq_cst);
+                if (word.load(std::memory_order_seq_cst) == seen)
+                {
+                    futexWait(word, seen, remaining);
+                }
+                waiting.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        /// @brief Signals a change of `word`, waking one blocked thread if there is any.
+        static void notify(std::atomic<unsigned int> &word, std::atomic<unsigned int> &waiting)
+        {
+            word.fetch_add(1, std::memory_order_seq_cst);
+            if (waiting.load(std::memory_order_seq_cst) > 0)
+            {
+                futexWake(word, 1);
+            }
+        }
+
+    public:
+        /// @brief Constructs an empty BlockingQueue.
+        BlockingQueue() : enqueued_(0), dequeued_(0), consumersWaiting_(0), producersWaiting_(0) {}
+
+        BlockingQueue(const BlockingQueue &) = delete;
+        BlockingQueue &operator=(const BlockingQueue &) = delete;
+
+        /// @brief Adds an item to the back of the queue without waiting.
+        /// @return True if the item was added, false if the queue is full.
+        /// @param item The item to add.
+        bool enqueue(const T &item)
+        {
+            bool added;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                added = queue_.enqueue(item);
+            }
+            if (added)
+            {
+                notify(enqueued_, consumersWaiting_);
+            }
+            return added;
+        }
+
+        /// @brief Adds an item to the back of the queue, waiting for space if the queue is full.
+        /// @param item The item to add.
+        /// @param timeout The maximum time to wait for space.
+        /// @return True if the item was added, false if the queue stayed full until the timeout passed.
+        bool enqueueWait(const T &item, Duration timeout)
+        {
+            return waitFor<bool>([this, &item]() { return enqueue(item); }, dequeued_, producersWaiting_, timeout);
+        }
+
+        /// @brief Removes and returns the item at the front of the queue without waiting.
+        /// @return An Option containing the item if the queue is not empty, or an empty Option if the queue is empty.
+        Option<T> dequeue()
+        {
+            Option<T> item;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                item = queue_.dequeue();
+            }
+            if (item)
+            {
+                notify(dequeued_, producersWaiting_);
+            }
+            return item;
+        }
+
+        /// @brief Removes and returns the item at the front of the queue, waiting for an item if the queue is empty.
+        /// @param timeout The maximum time to wait for an item.
+        /// @return An Option containing the item, or an empty Option if the queue stayed empty until the timeout passed.
+        Option<T> dequeueWait(Duration timeout)
+        {
+            return waitFor<Option<T>>([this]() { return dequeue(); }, enqueued_, consumersWaiting_, timeout);
+        }
+
+        /// @brief Returns the number of elements in the queue.
+        /// @return The number of elements in the queue.
+        /// @note The result is only a snapshot when other threads are using the queue.
+        unsigned int size() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return queue_.size();
+        }
+
+        /// @brief Returns the maximum capacity of the queue.
+        /// @return The maximum capacity of the queue.
+        constexpr unsigned int capacity() const
+        {
+            return Capacity;
+        }
+
+        /// @brief Checks if the queue is full.
+        /// @return True if the queue is full, false otherwise.
+        /// @note The result is only a snapshot when other threads are using the queue.
+        bool isFull() const
+        {
+            return size() == Capacity;
+        }
+
+        /// @brief Checks if the queue is empty.
+        /// @return True if the queue is empty, false otherwise.
+        /// @note The result is only a snapshot when other threads are using the queue.
+        bool isEmpty() const
+        {
+            return size() == 0;
+        }
+    };
+
+    template <typename T, unsigned int Capacity>
+    constexpr int BlockingQueue<T, Capacity>::SpinCount;
+}
+
+#endif // FENZ_BLOCKING_QUEUE_HPP
@@ -0,0 +1,114 @@
+#include "time.hpp"
+
+#ifndef FENZ_CACHED_CLOCK_HPP
+#define FENZ_CACHED_CLOCK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace fenz
+{
+    /// @brief A clock whose current time is refreshed by a background thread, so that reading it is a single relaxed atomic load.
+    /// @details Meant for timestamping at high rates where a coarse but very cheap "now" is good enough.
+    ///
+    ///          Staleness: `now()` never runs ahead of `MomentType::now()`. It lags behind by at most the time between two
+    ///          refreshes, which is `interval()` plus however long the ticker thread was delayed by the OS scheduler.
+    ///          `observedMaxStaleness()` reports the largest gap between refreshes seen so far, and `staleness()` measures the current lag.
+    /// @tparam MomentType The Moment type to cache, which also determines the time source that is read.
+    template <typename MomentType = Moment>
+    class BasicCachedClock
+    {
+    private:
+        std::atomic<MomentType> current_;
+        const Nanoseconds interval_;
+        std::atomic<long long> maxGapNanos_;
+
+        std::mutex mutex_;
+        std::condition_variable stopSignal_;
+        bool stopping_;
+        std::thread ticker_;
+
+        void tickerLoop()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stopping_)
+            {
+                stopSignal_.wait_for(lock, std::chrono::nanoseconds(interval_.nanos()));
+                refresh();
+            }
+        }
+
+    public:
+        /// @brief Constructs a CachedClock and starts its ticker thread.
+        /// @param interval How often the cached time is refreshed.
+        explicit BasicCachedClock(Nanoseconds interval)
+            : current_(MomentType::now()), interval_(interval), maxGapNanos_(0), stopping_(false)
+        {
+            ticker_ = std::thread(&BasicCachedClock::tickerLoop, this);
+        }
+
+        /// @brief Destructor. Stops and joins the ticker thread.
+        ~BasicCachedClock()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            stopSignal_.notify_one();
+            ticker_.join();
+        }
+
+        BasicCachedClock(const BasicCachedClock &) = delete;
+        BasicCachedClock &operator=(const BasicCachedClock &) = delete;
+
+        /// @brief Returns the cached current time.
+        /// @return The time at the most recent refresh.
+        MomentType now() const
+        {
+            return current_.load(std::memory_order_relaxed);
+        }
+
+        /// @brief Reads the time source and updates the cached time immediately.
+        /// @note Called by the ticker thread every interval. Can also be called by any thread that needs a fresher value.
+        void refresh()
+        {
+            MomentType fresh = MomentType::now();
+            MomentType previous = current_.exchange(fresh, std::memory_order_relaxed);
+            Nanoseconds gap = fresh - previous;
+            long long seen = maxGapNanos_.load(std::memory_order_relaxed);
+            while (gap.nanos() > seen && !maxGapNanos_.compare_exchange_weak(seen, gap.nanos(), std::memory_order_relaxed))
+            {
+            }
+        }
+
+        /// @brief Returns how often the cached time is refreshed, which is the nominal bound on its staleness.
+        /// @return The refresh interval.
+        Nanoseconds interval() const
+        {
+            return interval_;
+        }
+
+        /// @brief Returns the largest gap between two refreshes seen so far.
+        /// @return The worst staleness observed, at the precision of `MomentType`.
+        Nanoseconds observedMaxStaleness() const
+        {
+            return Nanoseconds::fromNanos(maxGapNanos_.load(std::memory_order_relaxed));
+        }
+
+        /// @brief Measures how far the cached time currently lags behind the time source.
+        /// @return The current staleness.
+        /// @note This reads the time source, so it costs as much as `MomentType::now()`.
+        Nanoseconds staleness() const
+        {
+            return MomentType::now() - now();
+        }
+    };
+
+    /// A CachedClock of millisecond `Moment`s.
+    typedef BasicCachedClock<Moment> CachedClock;
+}
+
+#endif // FENZ_CACHED_CLOCK_HPP
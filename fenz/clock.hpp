@@ -0,0 +1,125 @@
+#include "time.hpp"
+
+#ifndef FENZ_CLOCK_HPP
+#define FENZ_CLOCK_HPP
+
+#include <atomic>
+
+namespace fenz
+{
+    /// @brief Reads a Clock as a Moment.
+    /// @tparam MomentType The Moment type to return.
+    /// @param clock The Clock to read.
+    /// @return The Clock's current time, truncated to whole ticks of `MomentType`.
+    template <typename MomentType>
+    inline MomentType clockNow(Clock &clock)
+    {
+        return MomentType::fromTicks(static_cast<typename MomentType::rep>(
+            detail::convertTicks<Nano, typename MomentType::period, long long>(clock.nowNanos())));
+    }
+
+    /// @brief A Clock that only moves when told to, for deterministic tests, simulations and replay of recorded time.
+    /// @details The time is a single atomic, so one ManualClock can be installed on many threads and advanced from any of them.
+    class ManualClock : public Clock
+    {
+    private:
+        std::atomic<long long> nanos_;
+
+    public:
+        /// @brief Constructs a ManualClock.
+        /// @param start The initial time, in nanoseconds since an arbitrary start time.
+        explicit ManualClock(long long start = 0) : nanos_(start) {}
+
+        ManualClock(const ManualClock &) = delete;
+        ManualClock &operator=(const ManualClock &) = delete;
+
+        long long nowNanos() override
+        {
+            return nanos_.load(std::memory_order_acquire);
+        }
+
+        /// @brief Moves the time forward.
+        /// @param duration How far to move. Durations with any tick length of at least a nanosecond are accepted.
+        void advance(Nanoseconds duration)
+        {
+            nanos_.fetch_add(duration.nanos(), std::memory_order_acq_rel);
+        }
+
+        /// @brief Sets the time, e.g. to a timestamp being replayed.
+        /// @param nanos The new time, in nanoseconds since the same start time as the initial time. May move backwards.
+        void set(long long nanos)
+        {
+            nanos_.store(nanos, std::memory_order_release);
+        }
+    };
+
+    /// @brief A Clock that runs a fixed number of times faster (or slower) than another clock, for load simulations.
+    /// @details Starts at the same time as the underlying clock, and from then on advances `scale` nanoseconds for every
+    ///          nanosecond of the underlying clock.
+    class ScaledClock : public Clock
+    {
+    private:
+        Clock *base_;
+        double scale_;
+        long long baseStart_;
+
+        long long readBase()
+        {
+            // Read the global time source directly, not through Moment, so that installing this clock does not make it read itself
+            return base_ != nullptr ? base_->nowNanos() : fenzTimeSourceNanos();
+        }
+
+    public:
+        /// @brief Constructs a ScaledClock.
+        /// @param scale How many nanoseconds the clock advances per nanosecond of the underlying clock.
+        /// @param base The underlying clock, which must outlive this one. If null, `fenzTimeSourceNanos` is used.
+        explicit ScaledClock(double scale, Clock *base = nullptr) : base_(base), scale_(scale), baseStart_(readBase()) {}
+
+        ScaledClock(const ScaledClock &) = delete;
+        ScaledClock &operator=(const ScaledClock &) = delete;
+
+        long long nowNanos() override
+        {
+            return baseStart_ + static_cast<long long>(static_cast<double>(readBase() - baseStart_) * scale_);
+        }
+
+        /// @brief Returns how much faster than the underlying clock this clock runs.
+        /// @return The scale factor.
+        double scale() const
+        {
+            return scale_;
+        }
+    };
+
+#if defined(FENZ_ENABLE_CLOCK_OVERRIDE)
+    /// @brief Makes `Moment::now()` and the other Moment types read a Clock instead of the global time source on the
+    ///        calling thread, for as long as the ClockScope exists.
+    /// @details Scopes can be nested; the previous Clock is restored when a scope ends. Other threads are not affected,
+    ///          so each thread that should see the Clock must install its own ClockScope.
+    /// @note Only available when `FENZ_ENABLE_CLOCK_OVERRIDE` is defined, which must be the same in all translation units.
+    class ClockScope
+    {
+    private:
+        Clock *previous_;
+
+    public:
+        /// @brief Installs a Clock on the calling thread.
+        /// @param clock The Clock to install. Must outlive the scope.
+        explicit ClockScope(Clock &clock) : previous_(detail::clockOverride())
+        {
+            detail::clockOverride() = &clock;
+        }
+
+        /// @brief Restores the previously installed Clock, or the global time source.
+        ~ClockScope()
+        {
+            detail::clockOverride() = previous_;
+        }
+
+        ClockScope(const ClockScope &) = delete;
+        ClockScope &operator=(const ClockScope &) = delete;
+    };
+#endif
+}
+
+#endif // FENZ_CLOCK_HPP
@@ -0,0 +1,234 @@
+#include "array.hpp"
+#include "option.hpp"
+
+#ifndef FENZ_DEQUE_HPP
+#define FENZ_DEQUE_HPP
+
+namespace fenz
+{
+    /// @brief The contents of a Deque as at most two contiguous spans, in order from front to back.
+    /// @details `second` is empty unless the contents wrap around the end of the ring.
+    /// @tparam T Type of the elements in the spans.
+    template <typename T>
+    struct DequeSegments
+    {
+        /// The elements from the front of the deque up to the end of the ring storage.
+        Span<T> first;
+        /// The elements that wrapped around to the start of the ring storage.
+        Span<T> second;
+    };
+
+    /// @brief A double-ended circular queue with a max capacity.
+    /// @details Items can be added and removed at both ends in O(1), and accessed by their position relative to the front.
+    /// @tparam T The type of elements in the deque. Must be default constructible.
+    /// @tparam Capacity The maximum number of elements the deque can hold.
+    template <typename T, unsigned int Capacity>
+    class Deque
+    {
+        static_assert(Capacity > 0, "Deque capacity must be greater than zero");
+
+    private:
+        T data_[Capacity];
+        unsigned int front_;
+        unsigned int count_;
+
+        /// @brief Returns the storage index of the item at a position relative to the front.
+        /// @param position Position relative to the front, less than `Capacity`.
+        unsigned int physical(unsigned int position) const
+        {
+            unsigned int index = front_ + position;
+            return index >= Capacity ? index - Capacity : index;
+        }
+
+    public:
+        /// @brief Constructs an empty Deque.
+        Deque() : front_(0), count_(0) {}
+
+        /// @brief Adds an item to the back of the deque.
+        /// @return True if the item was added, false if the deque is full.
+        /// @param item The item to add.
+        bool pushBack(const T &item)
+        {
+            if (isFull())
+            {
+                return false;
+            }
+            data_[physical(count_)] = item;
+            count_++;
+            return true;
+        }
+
+        /// @brief Adds an item to the front of the deque.
+        /// @return True if the item was added, false if the deque is full.
+        /// @param item The item to add.
+        bool pushFront(const T &item)
+        {
+            if (isFull())
+            {
+                return false;
+            }
+            front_ = front_ == 0 ? Capacity - 1 : front_ - 1;
+            data_[front_] = item;
+            count_++;
+            return true;
+        }
+
+        /// @brief Adds an item to the back of the deque, overwriting the front item if the deque is full.
+        /// @param item The item to add.
+        void forcePushBack(const T &item)
+        {
+            if (isFull())
+            {
+                front_ = physical(1); // Overwrite the front item
+                count_--;
+            }
+            pushBack(item);
+        }
+
+        /// @brief Adds an item to the front of the deque, overwriting the back item if the deque is full.
+        /// @param item The item to add.
+        void forcePushFront(const T &item)
+        {
+            if (isFull())
+            {
+                count_--; // Overwrite the back item
+            }
+            pushFront(item);
+        }
+
+        /// @brief Removes and returns the item at the front of the deque.
+        /// @return An Option containing the item if the deque is not empty, or an empty Option if the deque is empty.
+        Option<T> popFront()
+        {
+            if (isEmpty())
+            {
+                return Option<T>();
+            }
+            Option<T> item = data_[front_];
+            front_ = physical(1);
+            count_--;
+            return item;
+        }
+
+        /// @brief Removes and returns the item at the back of the deque.
+        /// @return An Option containing the item if the deque is not empty, or an empty Option if the deque is empty.
+        Option<T> popBack()
+        {
+            if (isEmpty())
+            {
+                return Option<T>();
+            }
+            count_--;
+            return Option<T>(data_[physical(count_)]);
+        }
+
+        /// @brief Returns the item at the front of the deque without removing it.
+        /// @return An Option containing the item if the deque is not empty, or an empty Option if the deque is empty.
+        Option<T> front() const
+        {
+            return at(0);
+        }
+
+        /// @brief Returns the item at the back of the deque without removing it.
+        /// @return An Option containing the item if the deque is not empty, or an empty Option if the deque is empty.
+        Option<T> back() const
+        {
+            if (isEmpty())
+            {
+                return Option<T>();
+            }
+            return at(count_ - 1);
+        }
+
+        /// @brief Returns the item at a position relative to the front of the deque.
+        /// @param position Position of the item, where 0 is the front.
+        /// @return An Option containing the item, or an empty Option if the position is out of bounds.
+        Option<T> at(unsigned int position) const
+        {
+            if (position >= count_)
+            {
+                return Option<T>();
+            }
+            return Option<T>(data_[physical(position)]);
+        }
+
+        /// @brief Replaces the item at a position relative to the front of the deque.
+        /// @param position Position of the item, where 0 is the front.
+        /// @param item The new value of the item.
+        /// @return True if the item was replaced, false if the position is out of bounds.
+        bool set(unsigned int position, const T &item)
+        {
+            if (position >= count_)
+            {
+                return false;
+            }
+            data_[physical(position)] = item;
+            return true;
+        }
+
+        /// @brief Returns the contents of the deque as at most two contiguous spans, without copying.
+        /// @return The segments of the deque in order from front to back.
+        /// @note The spans are invalidated by any operation that adds or removes items.
+        DequeSegments<T> segments()
+        {
+            unsigned int untilEnd = Capacity - front_;
+            if (count_ <= untilEnd)
+            {
+                return {Span<T>(data_ + front_, static_cast<int>(count_)), Span<T>()};
+            }
+            return {Span<T>(data_ + front_, static_cast<int>(untilEnd)),
+                    Span<T>(data_, static_cast<int>(count_ - untilEnd))};
+        }
+
+        /// @brief Returns the contents of the deque as at most two contiguous read-only spans, without copying.
+        /// @return The segments of the deque in order from front to back.
+        /// @note The spans are invalidated by any operation that adds or removes items.
+        DequeSegments<const T> segments() const
+        {
+            unsigned int untilEnd = Capacity - front_;
+            if (count_ <= untilEnd)
+            {
+                return {Span<const T>(data_ + front_, static_cast<int>(count_)), Span<const T>()};
+            }
+            return {Span<const T>(data_ + front_, static_cast<int>(untilEnd)),
+                    Span<const T>(data_, static_cast<int>(count_ - untilEnd))};
+        }
+
+        /// @brief Removes all items from the deque.
+        void clear()
+        {
+            front_ = 0;
+            count_ = 0;
+        }
+
+        /// @brief Returns the number of elements in the deque.
+        /// @return The number of elements in the deque.
+        constexpr unsigned int size() const
+        {
+            return count_;
+        }
+
+        /// @brief Returns the maximum capacity of the deque.
+        /// @return The maximum capacity of the deque.
+        constexpr unsigned int capacity() const
+        {
+            return Capacity;
+        }
+
+        /// @brief Checks if the deque is full.
+        /// @return True if the deque is full, false otherwise.
+        bool isFull() const
+        {
+            return count_ == Capacity;
+        }
+
+        /// @brief Checks if the deque is empty.
+        /// @return True if the deque is empty, false otherwise.
+        bool isEmpty() const
+        {
+            return count_ == 0;
+        }
+    };
+}
+
+#endif // FENZ_DEQUE_HPP
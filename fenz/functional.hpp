@@ -0,0 +1,93 @@
+#ifndef FENZ_FUNCTIONAL_HPP
+#define FENZ_FUNCTIONAL_HPP
+
+namespace fenz
+{
+    namespace detail
+    {
+        /// @brief Keeps a parameter out of template argument deduction, so that e.g. `0` can be passed where an
+        ///        `unsigned int` is expected.
+        template <typename T>
+        struct NonDeduced
+        {
+            typedef T type;
+        };
+    }
+
+    /// @brief A comparison function object that orders elements with `operator<`.
+    /// @tparam T The type of elements to compare.
+    template <typename T>
+    struct Less
+    {
+        /// @brief Checks if one element is less than another.
+        /// @param lhs First element.
+        /// @param rhs Second element.
+        /// @return True if lhs < rhs.
+        constexpr bool operator()(const T &lhs, const T &rhs) const
+        {
+            return lhs < rhs;
+        }
+    };
+
+    /// @brief A comparison function object that orders elements with `operator>`.
+    /// @tparam T The type of elements to compare.
+    template <typename T>
+    struct Greater
+    {
+        /// @brief Checks if one element is greater than another.
+        /// @param lhs First element.
+        /// @param rhs Second element.
+        /// @return True if lhs > rhs.
+        constexpr bool operator()(const T &lhs, const T &rhs) const
+        {
+            return lhs > rhs;
+        }
+    };
+
+    /// @brief A function object that adds two values with `operator+`.
+    /// @tparam T The type of values to add.
+    template <typename T>
+    struct Plus
+    {
+        /// @brief Adds two values.
+        /// @param lhs First value.
+        /// @param rhs Second value.
+        /// @return lhs + rhs.
+        constexpr T operator()(const T &lhs, const T &rhs) const
+        {
+            return lhs + rhs;
+        }
+    };
+
+    /// @brief A function object that returns the smaller of two values, using `operator<`.
+    /// @tparam T The type of values to compare.
+    template <typename T>
+    struct Min
+    {
+        /// @brief Returns the smaller of two values.
+        /// @param lhs First value.
+        /// @param rhs Second value.
+        /// @return rhs if rhs < lhs, otherwise lhs.
+        constexpr T operator()(const T &lhs, const T &rhs) const
+        {
+            return rhs < lhs ? rhs : lhs;
+        }
+    };
+
+    /// @brief A function object that returns the larger of two values, using `operator<`.
+    /// @tparam T The type of values to compare.
+    template <typename T>
+    struct Max
+    {
+        /// @brief Returns the larger of two values.
+        /// @param lhs First value.
+        /// @param rhs Second value.
+        /// @return rhs if lhs < rhs, otherwise lhs.
+        constexpr T operator()(const T &lhs, const T &rhs) const
+        {
+            return lhs < rhs ? rhs : lhs;
+        }
+    };
+}
+
+#endif // FENZ_FUNCTIONAL_HPP
@@ -0,0 +1,87 @@
+#include "time.hpp"
+
+#ifndef FENZ_FUTEX_HPP
+#define FENZ_FUTEX_HPP
+
+#include <atomic>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+namespace fenz
+{
+    static_assert(sizeof(std::atomic<unsigned int>) == sizeof(unsigned int), "futex words must be plain 32-bit integers");
+
+    /// @brief Hints to the CPU that the caller is spinning, reducing power use and contention with its sibling hyperthread.
+    inline void cpuRelax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    /// @brief Blocks the calling thread while `word` holds `expected`, or until the timeout passes.
+    /// @details On Linux this is a `futex` wait. Elsewhere it falls back to polling with short sleeps.
+    /// @param word The word to wait on.
+    /// @param expected The value `word` must hold for the thread to block.
+    /// @param timeout The maximum time to block for.
+    /// @param shared Set to true if `word` lives in memory shared between processes.
+    /// @return False if the timeout passed, true otherwise. A return of true does not guarantee that `word` changed,
+    ///         so callers must check their condition again.
+    inline bool futexWait(std::atomic<unsigned int> &word, unsigned int expected, Nanoseconds timeout, bool shared = false)
+    {
+        if (timeout.nanos() <= 0)
+        {
+            return word.load(std::memory_order_acquire) != expected;
+        }
+#if defined(__linux__)
+        timespec relative;
+        relative.tv_sec = static_cast<time_t>(timeout.nanos() / 1000000000);
+        relative.tv_nsec = static_cast<long>(timeout.nanos() % 1000000000);
+        long result = syscall(SYS_futex, reinterpret_cast<unsigned int *>(&word), shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE,
+                              expected, &relative, nullptr, 0);
+        return !(result == -1 && errno == ETIMEDOUT);
+#else
+        (void)shared;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeout.nanos());
+        while (word.load(std::memory_order_acquire) == expected)
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        return true;
+#endif
+    }
+
+    /// @brief Wakes up to `count` threads blocked in `futexWait` on `word`.
+    /// @param word The word that threads are waiting on.
+    /// @param count The maximum number of threads to wake.
+    /// @param shared Set to true if `word` lives in memory shared between processes.
+    inline void futexWake(std::atomic<unsigned int> &word, int count, bool shared = false)
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<unsigned int *>(&word), shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE,
+                count, nullptr, nullptr, 0);
+#else
+        // Waiters poll the word, so there is nothing to do
+        (void)word;
+        (void)count;
+        (void)shared;
+#endif
+    }
+}
+
+#endif // FENZ_FUTEX_HPP
@@ -0,0 +1,445 @@
+#include "array.hpp"
+
+#ifndef FENZ_HASH_HPP
+#define FENZ_HASH_HPP
+
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+namespace fenz
+{
+    namespace detail
+    {
+        /// @brief Lookup tables for CRC-32C, the Castagnoli polynomial in reflected form.
+        /// @details `entries[0]` updates a CRC by one byte. `entries[k]` gives the effect of a byte followed by `k`
+        ///          zero bytes, so eight bytes can be folded in with eight independent lookups.
+        struct Crc32cTableSet
+        {
+            unsigned int entries[8][256];
+        };
+
+        constexpr Crc32cTableSet makeCrc32cTables()
+        {
+            Crc32cTableSet tables = {};
+            for (unsigned int byte = 0; byte < 256; ++byte)
+            {
+                unsigned int crc = byte;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc >> 1) ^ ((crc & 1u) != 0 ? 0x82F63B78u : 0u);
+                }
+                tables.entries[0][byte] = crc;
+            }
+            for (int k = 1; k < 8; ++k)
+            {
+                for (int byte = 0; byte < 256; ++byte)
+                {
+                    unsigned int previous = tables.entries[k - 1][byte];
+                    tables.entries[k][byte] = (previous >> 8) ^ tables.entries[0][previous & 0xFFu];
+                }
+            }
+            return tables;
+        }
+
+        template <typename Unused = void>
+        struct Crc32cTables
+        {
+            static constexpr Crc32cTableSet value = makeCrc32cTables();
+        };
+
+        template <typename Unused>
+        constexpr Crc32cTableSet Crc32cTables<Unused>::value;
+
+        /// @brief Updates a CRC-32C one byte at a time. Usable in constant expressions.
+        template <typename Byte>
+        constexpr unsigned int crc32cBytewise(unsigned int state, const Byte *data, long long size)
+        {
+            for (long long i = 0; i < size; ++i)
+            {
+                unsigned int index = (state ^ static_cast<unsigned char>(data[i])) & 0xFFu;
+                state = (state >> 8) ^ Crc32cTables<>::value.entries[0][index];
+            }
+            return state;
+        }
+
+        /// @brief Updates a CRC-32C with the `crc32` instruction when SSE4.2 is enabled, e.g. with `-msse4.2` or
+        ///        `-march=native`, and with eight table lookups per eight bytes otherwise.
+        inline unsigned int crc32cUpdate(unsigned int state, const unsigned char *data, long long size)
+        {
+#if defined(__SSE4_2__)
+#if defined(__x86_64__) || defined(_M_X64)
+            unsigned long long wide = state;
+            for (; size >= 8; size -= 8, data += 8)
+            {
+                unsigned long long word;
+                std::memcpy(&word, data, sizeof(word));
+                wide = _mm_crc32_u64(wide, word);
+            }
+            state = static_cast<unsigned int>(wide);
+#endif
+            for (; size >= 4; size -= 4, data += 4)
+            {
+                unsigned int word;
+                std::memcpy(&word, data, sizeof(word));
+                state = _mm_crc32_u32(state, word);
+            }
+            for (; size > 0; --size, ++data)
+            {
+                state = _mm_crc32_u8(state, *data);
+            }
+            return state;
+#else
+            const Crc32cTableSet &tables = Crc32cTables<>::value;
+            for (; size >= 8; size -= 8, data += 8)
+            {
+                unsigned int low = state ^ (static_cast<unsigned int>(data[0]) | static_cast<unsigned int>(data[1]) << 8 |
+                                            static_cast<unsigned int>(data[2]) << 16 | static_cast<unsigned int>(data[3]) << 24);
+                state = tables.entries[7][low & 0xFFu] ^ tables.entries[6][(low >> 8) & 0xFFu] ^
+                        tables.entries[5][(low >> 16) & 0xFFu] ^ tables.entries[4][low >> 24] ^
+                        tables.entries[3][data[4]] ^ tables.entries[2][data[5]] ^
+                        tables.entries[1][data[6]] ^ tables.entries[0][data[7]];
+            }
+            return crc32cBytewise(state, data, size);
+#endif
+        }
+
+        constexpr unsigned long long Hash64Prime1 = 0x9E3779B185EBCA87ULL;
+        constexpr unsigned long long Hash64Prime2 = 0xC2B2AE3D27D4EB4FULL;
+        constexpr unsigned long long Hash64Prime3 = 0x165667B19E3779F9ULL;
+        constexpr unsigned long long Hash64Prime4 = 0x85EBCA77C2B2AE63ULL;
+        constexpr unsigned long long Hash64Prime5 = 0x27D4EB2F165667C5ULL;
+
+        constexpr unsigned long long rotateLeft64(unsigned long long value, int bits)
+        {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        /// @brief Reads a little-endian 32-bit word. Compilers turn this into a single load on little-endian machines.
+        template <typename Byte>
+        constexpr unsigned long long readLittleEndian32(const Byte *data)
+        {
+            return static_cast<unsigned long long>(static_cast<unsigned char>(data[0])) |
+                   static_cast<unsigned long long>(static_cast<unsigned char>(data[1])) << 8 |
+                   static_cast<unsigned long long>(static_cast<unsigned char>(data[2])) << 16 |
+                   static_cast<unsigned long long>(static_cast<unsigned char>(data[3])) << 24;
+        }
+
+        /// @brief Reads a little-endian 64-bit word. Compilers turn this into a single load on little-endian machines.
+        template <typename Byte>
+        constexpr unsigned long long readLittleEndian64(const Byte *data)
+        {
+            return readLittleEndian32(data) | readLittleEndian32(data + 4) << 32;
+        }
+
+        constexpr unsigned long long hash64Round(unsigned long long lane, unsigned long long input)
+        {
+            return rotateLeft64(lane + input * Hash64Prime2, 31) * Hash64Prime1;
+        }
+
+        constexpr unsigned long long hash64Merge(unsigned long long hash, unsigned long long lane)
+        {
+            return (hash ^ hash64Round(0, lane)) * Hash64Prime1 + Hash64Prime4;
+        }
+
+        /// @brief The state of the four independent lanes that consume 32-byte stripes.
+        struct Hash64Lanes
+        {
+            unsigned long long lanes[4];
+        };
+
+        constexpr Hash64Lanes hash64Start(unsigned long long seed)
+        {
+            return Hash64Lanes{{seed + Hash64Prime1 + Hash64Prime2, seed + Hash64Prime2, seed, seed - Hash64Prime1}};
+        }
+
+        /// @brief Consumes the whole 32-byte stripes of `data`. Usable in constant expressions.
+        template <typename Byte>
+        constexpr Hash64Lanes hash64Stripes(Hash64Lanes state, const Byte *data, long long stripes)
+        {
+            for (long long stripe = 0; stripe < stripes; ++stripe, data += 32)
+            {
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    state.lanes[lane] = hash64Round(state.lanes[lane], readLittleEndian64(data + 8 * lane));
+                }
+            }
+            return state;
+        }
+
+        /// @brief Consumes the whole 32-byte stripes of `data`, as `hash64Stripes` does, at run time.
+        inline Hash64Lanes hash64StripesScalar(const Hash64Lanes &state, const unsigned char *data, long long stripes)
+        {
+            unsigned long long lane0 = state.lanes[0];
+            unsigned long long lane1 = state.lanes[1];
+            unsigned long long lane2 = state.lanes[2];
+            unsigned long long lane3 = state.lanes[3];
+            for (long long stripe = 0; stripe < stripes; ++stripe, data += 32)
+            {
+                lane0 = hash64Round(lane0, readLittleEndian64(data));
+                lane1 = hash64Round(lane1, readLittleEndian64(data + 8));
+                lane2 = hash64Round(lane2, readLittleEndian64(data + 16));
+                lane3 = hash64Round(lane3, readLittleEndian64(data + 24));
+#if defined(__GNUC__) || defined(__clang__)
+                // Keeps the compiler from packing the lanes into one vector: without AVX-512, 64-bit vector multiplies
+                // have to be emulated, and with it they are slower than four independent scalar multiplies
+                __asm__("" : "+r"(lane0), "+r"(lane1), "+r"(lane2), "+r"(lane3));
+#endif
+            }
+            return Hash64Lanes{{lane0, lane1, lane2, lane3}};
+        }
+
+        /// @brief Combines the lanes, mixes in the last bytes that did not fill a stripe, and avalanches the result.
+        /// @param length The total number of bytes hashed.
+        /// @param tail The last `length % 32` bytes.
+        template <typename Byte>
+        constexpr unsigned long long hash64Finish(const Hash64Lanes &state, unsigned long long seed, long long length,
+                                                  const Byte *tail)
+        {
+            unsigned long long hash = seed + Hash64Prime5;
+            if (length >= 32)
+            {
+                hash = rotateLeft64(state.lanes[0], 1) + rotateLeft64(state.lanes[1], 7) +
+                       rotateLeft64(state.lanes[2], 12) + rotateLeft64(state.lanes[3], 18);
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    hash = hash64Merge(hash, state.lanes[lane]);
+                }
+            }
+            hash += static_cast<unsigned long long>(length);
+
+            long long size = length % 32;
+            for (; size >= 8; size -= 8, tail += 8)
+            {
+                hash = rotateLeft64(hash ^ hash64Round(0, readLittleEndian64(tail)), 27) * Hash64Prime1 + Hash64Prime4;
+            }
+            if (size >= 4)
+            {
+                hash = rotateLeft64(hash ^ (readLittleEndian32(tail) * Hash64Prime1), 23) * Hash64Prime2 + Hash64Prime3;
+                size -= 4;
+                tail += 4;
+            }
+            for (; size > 0; --size, ++tail)
+            {
+                hash = rotateLeft64(hash ^ (static_cast<unsigned char>(*tail) * Hash64Prime5), 11) * Hash64Prime1;
+            }
+
+            hash ^= hash >> 33;
+            hash *= Hash64Prime2;
+            hash ^= hash >> 29;
+            hash *= Hash64Prime3;
+            hash ^= hash >> 32;
+            return hash;
+        }
+
+        /// @brief Hashes bytes in one call. Usable in constant expressions.
+        template <typename Byte>
+        constexpr unsigned long long hash64Bytes(const Byte *data, long long size, unsigned long long seed)
+        {
+            return hash64Finish(hash64Stripes(hash64Start(seed), data, size / 32), seed, size, data + size / 32 * 32);
+        }
+
+        /// @brief Hashes bytes in one call, as `hash64Bytes` does, at run time.
+        inline unsigned long long hash64BytesScalar(const unsigned char *data, long long size, unsigned long long seed)
+        {
+            return hash64Finish(hash64StripesScalar(hash64Start(seed), data, size / 32), seed, size, data + size / 32 * 32);
+        }
+
+        /// @brief Views the elements of a contiguous range as bytes.
+        template <typename T>
+        inline const unsigned char *bytesOf(const T *items)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable elements can be hashed as bytes");
+            return reinterpret_cast<const unsigned char *>(items);
+        }
+    }
+
+    /// @brief Computes a CRC-32C (Castagnoli) checksum incrementally, as used by iSCSI, ext4 and many storage formats.
+    /// @details Uses the SSE4.2 `crc32` instruction, eight bytes at a time, when it is enabled, e.g. with `-msse4.2` or
+    ///          `-march=native`. Otherwise uses table lookups, eight bytes at a time.
+    ///          Feeding the bytes in several updates gives the same checksum as feeding them at once.
+    class Crc32c
+    {
+    private:
+        unsigned int state_;
+
+    public:
+        /// @brief Constructs a checksum of no bytes.
+        constexpr Crc32c() : state_(0xFFFFFFFFu) {}
+
+        /// @brief Adds the bytes of elements to the checksum.
+        /// @tparam T A trivially copyable element type. Padding bytes, if any, are included.
+        /// @param items The elements to add.
+        /// @return Reference to this checksum.
+        template <typename T, int N>
+        Crc32c &update(const Iterable<T, N> &items)
+        {
+            state_ = detail::crc32cUpdate(state_, detail::bytesOf(items.begin()), static_cast<long long>(N) * sizeof(T));
+            return *this;
+        }
+
+        /// @brief Adds the bytes of elements to the checksum.
+        /// @tparam T A trivially copyable element type. Padding bytes, if any, are included.
+        /// @param items The elements to add.
+        /// @return Reference to this checksum.
+        template <typename T>
+        Crc32c &update(const Span<T> &items)
+        {
+            state_ = detail::crc32cUpdate(state_, detail::bytesOf(items.data()), static_cast<long long>(items.size()) * sizeof(T));
+            return *this;
+        }
+
+        /// @brief Returns the checksum of all bytes added so far. More bytes can still be added.
+        unsigned int value() const
+        {
+            return ~state_;
+        }
+
+        /// @brief Resets to the checksum of no bytes.
+        void reset()
+        {
+            state_ = 0xFFFFFFFFu;
+        }
+    };
+
+    /// @brief Computes a 64-bit non-cryptographic hash incrementally. Produces the same values as XXH64.
+    /// @details Four independent lanes consume 32 bytes per step, so long inputs hash at several bytes per cycle.
+    ///          Suitable for hash tables and sharding, not for security: inputs that collide can be constructed.
+    ///          Feeding the bytes in several updates gives the same hash as feeding them at once.
+    class Hash64
+    {
+    private:
+        detail::Hash64Lanes lanes_;
+        unsigned long long seed_;
+        long long length_;
+        unsigned char buffer_[32];
+
+        void updateBytes(const unsigned char *data, long long size)
+        {
+            int buffered = static_cast<int>(length_ % 32);
+            length_ += size;
+            if (buffered + size < 32)
+            {
+                std::memcpy(buffer_ + buffered, data, static_cast<size_t>(size));
+                return;
+            }
+            if (buffered > 0)
+            {
+                // Complete the buffered stripe first
+                int fill = 32 - buffered;
+                std::memcpy(buffer_ + buffered, data, static_cast<size_t>(fill));
+                lanes_ = detail::hash64StripesScalar(lanes_, buffer_, 1);
+                data += fill;
+                size -= fill;
+            }
+            lanes_ = detail::hash64StripesScalar(lanes_, data, size / 32);
+            std::memcpy(buffer_, data + size / 32 * 32, static_cast<size_t>(size % 32));
+        }
+
+    public:
+        /// @brief Constructs a hash of no bytes.
+        /// @param seed Selects a different hash function, e.g. to make hashes differ between processes.
+        explicit Hash64(unsigned long long seed = 0) : lanes_(detail::hash64Start(seed)), seed_(seed), length_(0) {}
+
+        /// @brief Adds the bytes of elements to the hash.
+        /// @tparam T A trivially copyable element type. Padding bytes, if any, are included.
+        /// @param items The elements to add.
+        /// @return Reference to this hash.
+        template <typename T, int N>
+        Hash64 &update(const Iterable<T, N> &items)
+        {
+            updateBytes(detail::bytesOf(items.begin()), static_cast<long long>(N) * sizeof(T));
+            return *this;
+        }
+
+        /// @brief Adds the bytes of elements to the hash.
+        /// @tparam T A trivially copyable element type. Padding bytes, if any, are included.
+        /// @param items The elements to add.
+        /// @return Reference to this hash.
+        template <typename T>
+        Hash64 &update(const Span<T> &items)
+        {
+            updateBytes(detail::bytesOf(items.data()), static_cast<long long>(items.size()) * sizeof(T));
+            return *this;
+        }
+
+        /// @brief Returns the hash of all bytes added so far. More bytes can still be added.
+        unsigned long long value() const
+        {
+            return detail::hash64Finish(lanes_, seed_, length_, buffer_);
+        }
+
+        /// @brief Resets to the hash of no bytes, keeping the seed.
+        void reset()
+        {
+            lanes_ = detail::hash64Start(seed_);
+            length_ = 0;
+        }
+    };
+
+    /// @brief Computes the CRC-32C checksum of the bytes of an Iterable.
+    /// @tparam T A trivially copyable element type, e.g. `unsigned char`.
+    /// @param items The elements to checksum.
+    /// @return The checksum.
+    template <typename T, int N>
+    inline unsigned int crc32c(const Iterable<T, N> &items)
+    {
+        return Crc32c().update(items).value();
+    }
+
+    /// @brief Computes the CRC-32C checksum of the bytes of a Span.
+    /// @tparam T A trivially copyable element type, e.g. `unsigned char`.
+    /// @param items The elements to checksum.
+    /// @return The checksum.
+    template <typename T>
+    inline unsigned int crc32c(const Span<T> &items)
+    {
+        return Crc32c().update(items).value();
+    }
+
+    /// @brief Computes the CRC-32C checksum of a string literal at compile time, excluding the terminating null.
+    /// @param text The string literal.
+    /// @return The checksum, as a constant expression.
+    template <int N>
+    constexpr unsigned int crc32cLiteral(const char (&text)[N])
+    {
+        return ~detail::crc32cBytewise(0xFFFFFFFFu, text, N - 1);
+    }
+
+    /// @brief Computes the 64-bit hash of the bytes of an Iterable, as `Hash64` does.
+    /// @tparam T A trivially copyable element type. Padding bytes, if any, are included.
+    /// @param items The elements to hash.
+    /// @param seed Selects a different hash function.
+    /// @return The hash.
+    template <typename T, int N>
+    inline unsigned long long hash64(const Iterable<T, N> &items, unsigned long long seed = 0)
+    {
+        return detail::hash64BytesScalar(detail::bytesOf(items.begin()), static_cast<long long>(N) * sizeof(T), seed);
+    }
+
+    /// @brief Computes the 64-bit hash of the bytes of a Span, as `Hash64` does.
+    /// @tparam T A trivially copyable element type. Padding bytes, if any, are included.
+    /// @param items The elements to hash.
+    /// @param seed Selects a different hash function.
+    /// @return The hash.
+    template <typename T>
+    inline unsigned long long hash64(const Span<T> &items, unsigned long long seed = 0)
+    {
+        return detail::hash64BytesScalar(detail::bytesOf(items.data()), static_cast<long long>(items.size()) * sizeof(T), seed);
+    }
+
+    /// @brief Computes the 64-bit hash of a string literal at compile time, excluding the terminating null.
+    /// @param text The string literal.
+    /// @param seed Selects a different hash function.
+    /// @return The hash, as a constant expression.
+    template <int N>
+    constexpr unsigned long long hash64Literal(const char (&text)[N], unsigned long long seed = 0)
+    {
+        return detail::hash64Bytes(text, N - 1, seed);
+    }
+}
+
+#endif // FENZ_HASH_HPP
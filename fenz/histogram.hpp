@@ -0,0 +1,225 @@
+#include "bitarray.hpp"
+#include "time.hpp"
+
+#ifndef FENZ_HISTOGRAM_HPP
+#define FENZ_HISTOGRAM_HPP
+
+#include <atomic>
+
+namespace fenz
+{
+    /// @brief A lock-free histogram of latencies with log-linear buckets, in the style of HdrHistogram.
+    /// @details Values below `2^SubBucketBits` nanoseconds get a bucket each. Above that, every power of two is split into
+    ///          `2^(SubBucketBits - 1)` equally wide buckets, so the relative error of any recorded value is at most
+    ///          `2^-(SubBucketBits - 1)` (about 1.6% for the default of 7) across the whole 64-bit nanosecond range.
+    ///
+    ///          Recording is O(1) and uses only relaxed atomic operations, so one instance can be shared by many threads.
+    ///          For the least contention, give each thread its own instance and `merge` them when reporting.
+    /// @tparam SubBucketBits Sets the precision. Memory use is `(66 - SubBucketBits) * 2^(SubBucketBits - 1)` counters.
+    template <int SubBucketBits = 7>
+    class LatencyHistogram
+    {
+        static_assert(SubBucketBits >= 2 && SubBucketBits <= 16, "SubBucketBits must be between 2 and 16");
+
+    private:
+        static constexpr int HalfBucket = 1 << (SubBucketBits - 1);
+        static constexpr int BucketCount = (66 - SubBucketBits) * HalfBucket;
+
+        std::atomic<unsigned long long> counts_[BucketCount];
+        std::atomic<unsigned long long> total_;
+        std::atomic<unsigned long long> sum_;
+        std::atomic<unsigned long long> min_;
+        std::atomic<unsigned long long> max_;
+
+        /// @brief Returns the bucket that a value falls in.
+        static int bucketOf(unsigned long long value)
+        {
+            if (value < (1ULL << SubBucketBits))
+            {
+                return static_cast<int>(value);
+            }
+            int highestBit = 63 - detail::countLeadingZeros64(value);
+            int shift = highestBit - SubBucketBits + 1;
+            return shift * HalfBucket + static_cast<int>(value >> shift);
+        }
+
+        /// @brief Returns the smallest value that falls in a bucket.
+        static unsigned long long lowestValueOf(int bucket)
+        {
+            if (bucket < 2 * HalfBucket)
+            {
+                return static_cast<unsigned long long>(bucket);
+            }
+            int shift = bucket / HalfBucket - 1;
+            return static_cast<unsigned long long>(bucket - shift * HalfBucket) << shift;
+        }
+
+        /// @brief Returns the largest value that falls in a bucket.
+        static unsigned long long highestValueOf(int bucket)
+        {
+            if (bucket < 2 * HalfBucket)
+            {
+                return static_cast<unsigned long long>(bucket);
+            }
+            int shift = bucket / HalfBucket - 1;
+            return lowestValueOf(bucket) + ((1ULL << shift) - 1);
+        }
+
+        static void raiseTo(std::atomic<unsigned long long> &target, unsigned long long value)
+        {
+            unsigned long long seen = target.load(std::memory_order_relaxed);
+            while (value > seen && !target.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        static void lowerTo(std::atomic<unsigned long long> &target, unsigned long long value)
+        {
+            unsigned long long seen = target.load(std::memory_order_relaxed);
+            while (value < seen && !target.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+    public:
+        /// @brief Constructs an empty LatencyHistogram.
+        LatencyHistogram()
+        {
+            reset();
+        }
+
+        LatencyHistogram(const LatencyHistogram &) = delete;
+        LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+        /// @brief Records a latency.
+        /// @param latency The latency to record. Negative latencies are recorded as zero.
+        void record(Nanoseconds latency)
+        {
+            unsigned long long value = latency.nanos() < 0 ? 0 : static_cast<unsigned long long>(latency.nanos());
+            counts_[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+            total_.fetch_add(1, std::memory_order_relaxed);
+            sum_.fetch_add(value, std::memory_order_relaxed);
+            lowerTo(min_, value);
+            raiseTo(max_, value);
+        }
+
+        /// @brief Returns the number of recorded latencies.
+        /// @return The number of recorded latencies.
+        unsigned long long count() const
+        {
+            return total_.load(std::memory_order_relaxed);
+        }
+
+        /// @brief Returns the smallest recorded latency, exactly.
+        /// @return The smallest latency, or zero if nothing was recorded.
+        Nanoseconds min() const
+        {
+            return count() == 0 ? Nanoseconds::fromNanos(0) : Nanoseconds::fromNanos(static_cast<long long>(min_.load(std::memory_order_relaxed)));
+        }
+
+        /// @brief Returns the largest recorded latency, exactly.
+        /// @return The largest latency, or zero if nothing was recorded.
+        Nanoseconds max() const
+        {
+            return Nanoseconds::fromNanos(static_cast<long long>(max_.load(std::memory_order_relaxed)));
+        }
+
+        /// @brief Returns the mean of the recorded latencies, exactly.
+        /// @return The mean latency, or zero if nothing was recorded.
+        Nanoseconds mean() const
+        {
+            unsigned long long n = count();
+            return n == 0 ? Nanoseconds::fromNanos(0) : Nanoseconds::fromNanos(static_cast<long long>(sum_.load(std::memory_order_relaxed) / n));
+        }
+
+        /// @brief Returns the latency at a percentile, e.g. 99.9 for p999.
+        /// @param percentile The percentile, between 0 and 100.
+        /// @return The highest latency in the bucket that contains the percentile, which is within the histogram's precision
+        ///         above the exact value and never above `max()`. Zero if nothing was recorded.
+        Nanoseconds percentile(double percentile) const
+        {
+            unsigned long long n = count();
+            if (n == 0)
+            {
+                return Nanoseconds::fromNanos(0);
+            }
+            percentile = percentile < 0.0 ? 0.0 : (percentile > 100.0 ? 100.0 : percentile);
+            unsigned long long rank = static_cast<unsigned long long>(percentile / 100.0 * static_cast<double>(n) + 0.5);
+            rank = rank == 0 ? 1 : rank;
+
+            unsigned long long seen = 0;
+            for (int bucket = 0; bucket < BucketCount; ++bucket)
+            {
+                seen += counts_[bucket].load(std::memory_order_relaxed);
+                if (seen >= rank)
+                {
+                    unsigned long long value = highestValueOf(bucket);
+                    unsigned long long largest = max_.load(std::memory_order_relaxed);
+                    return Nanoseconds::fromNanos(static_cast<long long>(value < largest ? value : largest));
+                }
+            }
+            return max();
+        }
+
+        /// @brief Adds all latencies recorded in another histogram to this one.
+        /// @param other The histogram to merge in. It is not modified.
+        void merge(const LatencyHistogram &other)
+        {
+            for (int bucket = 0; bucket < BucketCount; ++bucket)
+            {
+                unsigned long long n = other.counts_[bucket].load(std::memory_order_relaxed);
+                if (n != 0)
+                {
+                    counts_[bucket].fetch_add(n, std::memory_order_relaxed);
+                }
+            }
+            unsigned long long n = other.total_.load(std::memory_order_relaxed);
+            if (n != 0)
+            {
+                total_.fetch_add(n, std::memory_order_relaxed);
+                sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                lowerTo(min_, other.min_.load(std::memory_order_relaxed));
+                raiseTo(max_, other.max_.load(std::memory_order_relaxed));
+            }
+        }
+
+        /// @brief Moves all recorded latencies into another histogram and resets this one, for periodic export.
+        /// @details No latency recorded concurrently is lost: each ends up either in `snapshot` or in this histogram.
+        ///          The exact `min()`, `max()` and `mean()` of the two may be split slightly differently than the buckets
+        ///          when latencies are recorded during the move.
+        /// @param snapshot The histogram to add the recorded latencies to. Usually an empty one.
+        void snapshotAndReset(LatencyHistogram &snapshot)
+        {
+            unsigned long long moved = 0;
+            for (int bucket = 0; bucket < BucketCount; ++bucket)
+            {
+                unsigned long long n = counts_[bucket].exchange(0, std::memory_order_relaxed);
+                if (n != 0)
+                {
+                    snapshot.counts_[bucket].fetch_add(n, std::memory_order_relaxed);
+                    moved += n;
+                }
+            }
+            total_.fetch_sub(moved, std::memory_order_relaxed);
+            snapshot.total_.fetch_add(moved, std::memory_order_relaxed);
+            snapshot.sum_.fetch_add(sum_.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+            lowerTo(snapshot.min_, min_.exchange(~0ULL, std::memory_order_relaxed));
+            raiseTo(snapshot.max_, max_.exchange(0, std::memory_order_relaxed));
+        }
+
+        /// @brief Removes all recorded latencies.
+        void reset()
+        {
+            for (int bucket = 0; bucket < BucketCount; ++bucket)
+            {
+                counts_[bucket].store(0, std::memory_order_relaxed);
+            }
+            total_.store(0, std::memory_order_relaxed);
+            sum_.store(0, std::memory_order_relaxed);
+            min_.store(~0ULL, std::memory_order_relaxed);
+            max_.store(0, std::memory_order_relaxed);
+        }
+    };
+}
+
+#endif // FENZ_HISTOGRAM_HPP
@@ -0,0 +1,329 @@
+#include "array.hpp"
+#include "option.hpp"
+
+#ifndef FENZ_MAPPED_HPP
+#define FENZ_MAPPED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fenz
+{
+    /// @brief Tells the kernel how a mapped file will be accessed, so it can read ahead or back the mapping with
+    ///        huge pages.
+    enum MapAdvice
+    {
+        /// The default: moderate read-ahead.
+        AdviseNormal,
+        /// Elements will be read in order, so read ahead aggressively and drop pages soon after they are read.
+        AdviseSequential,
+        /// Elements will be read in no particular order, so do not read ahead.
+        AdviseRandom,
+        /// The whole file will be needed soon, so start reading it in now.
+        AdviseWillNeed,
+        /// Back the mapping with transparent huge pages, to reduce TLB misses on random access. Linux only.
+        AdviseHugePages
+    };
+
+    namespace detail
+    {
+        /// @brief Owns a memory mapping of a whole file and unmaps it on destruction.
+        class FileMapping
+        {
+        private:
+            void *address_;
+            size_t length_;
+
+        public:
+            FileMapping() : address_(nullptr), length_(0) {}
+
+            FileMapping(FileMapping &&other) : address_(other.address_), length_(other.length_)
+            {
+                other.address_ = nullptr;
+                other.length_ = 0;
+            }
+
+            FileMapping(const FileMapping &) = delete;
+            FileMapping &operator=(const FileMapping &) = delete;
+
+            ~FileMapping()
+            {
+#if defined(__unix__) || defined(__APPLE__)
+                if (length_ > 0)
+                {
+                    munmap(address_, length_);
+                }
+#endif
+            }
+
+            /// @brief Maps a file.
+            /// @param path The path of the file.
+            /// @param writable Map the file for writing, with writes going back to the file.
+            /// @param length Set to the size of the file in bytes.
+            /// @return False if the file could not be opened or mapped.
+            bool map(const char *path, bool writable, size_t &length)
+            {
+#if defined(__unix__) || defined(__APPLE__)
+                int file = ::open(path, writable ? O_RDWR : O_RDONLY);
+                if (file < 0)
+                {
+                    return false;
+                }
+                struct stat status;
+                if (fstat(file, &status) != 0 || status.st_size < 0)
+                {
+                    ::close(file);
+                    return false;
+                }
+                length = static_cast<size_t>(status.st_size);
+                if (length == 0)
+                {
+                    // Empty files cannot be mapped, and have no elements to access
+                    ::close(file);
+                    return true;
+                }
+                void *address = mmap(nullptr, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file, 0);
+                // The mapping keeps its own reference to the file
+                ::close(file);
+                if (address == MAP_FAILED)
+                {
+                    return false;
+                }
+                address_ = address;
+                length_ = length;
+                return true;
+#else
+                (void)path;
+                (void)writable;
+                (void)length;
+                return false;
+#endif
+            }
+
+            char *address() const
+            {
+                return static_cast<char *>(address_);
+            }
+
+            bool advise(MapAdvice advice)
+            {
+#if defined(__unix__) || defined(__APPLE__)
+                if (length_ == 0)
+                {
+                    return true;
+                }
+                int flag = MADV_NORMAL;
+                switch (advice)
+                {
+                case AdviseNormal:
+                    flag = MADV_NORMAL;
+                    break;
+                case AdviseSequential:
+                    flag = MADV_SEQUENTIAL;
+                    break;
+                case AdviseRandom:
+                    flag = MADV_RANDOM;
+                    break;
+                case AdviseWillNeed:
+                    flag = MADV_WILLNEED;
+                    break;
+                case AdviseHugePages:
+#if defined(MADV_HUGEPAGE)
+                    flag = MADV_HUGEPAGE;
+                    break;
+#else
+                    return false;
+#endif
+                }
+                return madvise(address_, length_, flag) == 0;
+#else
+                (void)advice;
+                return false;
+#endif
+            }
+
+            bool flush()
+            {
+#if defined(__unix__) || defined(__APPLE__)
+                return length_ == 0 || msync(address_, length_, MS_SYNC) == 0;
+#else
+                return false;
+#endif
+            }
+        };
+
+        /// @brief Checks that `offset` bytes into a file of `length` bytes is a valid start for elements of type `T`.
+        template <typename T>
+        inline bool isValidMappedStart(size_t length, size_t offset)
+        {
+            return offset <= length && offset % alignof(T) == 0;
+        }
+    }
+
+    /// @brief A file of exactly `N` elements, mapped into memory and accessed as an Iterable.
+    /// @details Opening the file takes the same time regardless of its size: pages are read in on first access and
+    ///          shared with the page cache, instead of being copied into a buffer first.
+    ///          With a const `T`, the file is mapped read-only. Otherwise it is mapped for writing, and writes go back
+    ///          to the file.
+    /// @tparam T The element type, e.g. `const Record`. Must be trivially copyable, since the bytes of the file are
+    ///         used as elements directly, in the byte order and layout of this machine.
+    /// @tparam N The number of elements the file must hold.
+    template <typename T, int N>
+    class MappedIterable : public Iterable<T, N>
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Mapped elements must be trivially copyable");
+
+    private:
+        detail::FileMapping mapping_;
+
+        MappedIterable(T *data, detail::FileMapping &&mapping) : Iterable<T, N>(data), mapping_(std::move(mapping)) {}
+
+    public:
+        MappedIterable(MappedIterable &&other) = default;
+        MappedIterable(const MappedIterable &) = delete;
+        MappedIterable &operator=(const MappedIterable &) = delete;
+
+        /// @brief Maps a file of elements.
+        /// @param path The path of the file.
+        /// @param offset The position of the first element in the file, in bytes, e.g. to skip a header. Must be a
+        ///        multiple of the alignment of `T`.
+        /// @return An Option containing the mapped file, or an empty Option if the file could not be opened or
+        ///         mapped, or if it does not hold exactly `N` elements after `offset`.
+        static Option<MappedIterable> open(const char *path, size_t offset = 0)
+        {
+            detail::FileMapping mapping;
+            size_t length = 0;
+            if (!mapping.map(path, !std::is_const<T>::value, length) || !detail::isValidMappedStart<T>(length, offset) ||
+                length - offset != static_cast<size_t>(N) * sizeof(T))
+            {
+                return Option<MappedIterable>();
+            }
+            T *data = reinterpret_cast<T *>(mapping.address() + offset);
+            return Option<MappedIterable>(MappedIterable(data, std::move(mapping)));
+        }
+
+        /// @brief Hints to the kernel how the file will be accessed.
+        /// @param advice The expected access pattern.
+        /// @return False if the hint is not supported on this platform.
+        bool advise(MapAdvice advice)
+        {
+            return mapping_.advise(advice);
+        }
+
+        /// @brief Writes modified elements back to the file, and waits until they are written.
+        /// @return False if the write failed.
+        bool flush()
+        {
+            return mapping_.flush();
+        }
+    };
+
+    /// @brief A file of elements, mapped into memory, whose number of elements is only known when it is opened.
+    /// @details As `MappedIterable`, for files whose size is not known at compile time. Fixed-size parts can be
+    ///          accessed as Iterables with `view`.
+    /// @tparam T The element type, e.g. `const Record`. Must be trivially copyable. With a const `T`, the file is
+    ///         mapped read-only.
+    template <typename T>
+    class MappedArray
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Mapped elements must be trivially copyable");
+
+    private:
+        detail::FileMapping mapping_;
+        T *data_;
+        int size_;
+
+        MappedArray(T *data, int size, detail::FileMapping &&mapping)
+            : mapping_(std::move(mapping)), data_(data), size_(size) {}
+
+    public:
+        MappedArray(MappedArray &&other) = default;
+        MappedArray(const MappedArray &) = delete;
+        MappedArray &operator=(const MappedArray &) = delete;
+
+        /// @brief Maps a file of elements.
+        /// @param path The path of the file.
+        /// @param offset The position of the first element in the file, in bytes, e.g. to skip a header. Must be a
+        ///        multiple of the alignment of `T`.
+        /// @return An Option containing the mapped file, or an empty Option if the file could not be opened or
+        ///         mapped, if the bytes after `offset` are not a whole number of elements, or if there are more than
+        ///         fit in an `int`.
+        static Option<MappedArray> open(const char *path, size_t offset = 0)
+        {
+            detail::FileMapping mapping;
+            size_t length = 0;
+            if (!mapping.map(path, !std::is_const<T>::value, length) || !detail::isValidMappedStart<T>(length, offset) ||
+                (length - offset) % sizeof(T) != 0 || (length - offset) / sizeof(T) > 0x7FFFFFFF)
+            {
+                return Option<MappedArray>();
+            }
+            T *data = length > 0 ? reinterpret_cast<T *>(mapping.address() + offset) : nullptr;
+            int size = static_cast<int>((length - offset) / sizeof(T));
+            return Option<MappedArray>(MappedArray(data, size, std::move(mapping)));
+        }
+
+        /// @brief Returns the number of elements in the file.
+        int size() const { return size_; }
+
+        /// @brief Checks if the file has no elements.
+        bool isEmpty() const { return size_ == 0; }
+
+        /// @brief Returns a view of all elements.
+        Span<T> span() const { return Span<T>(data_, size_); }
+
+        /// @brief Returns a view of `Size` elements, starting at `start`.
+        /// @tparam Size The number of elements to view.
+        /// @param start The index of the first element to view.
+        /// @return An Option containing the view, or an empty Option if the elements are not all in the file.
+        template <int Size>
+        Option<Iterable<T, Size>> view(int start) const
+        {
+            if (start < 0 || start > size_ - Size)
+            {
+                return Option<Iterable<T, Size>>();
+            }
+            return Option<Iterable<T, Size>>(Iterable<T, Size>(data_ + start));
+        }
+
+        /// @brief Performs an operation on each element.
+        /// @param func A callable taking `(T&, int)` — the element and its index.
+        template <typename Func>
+        void enumerate(Func func) const
+        {
+            for (int i = 0; i < size_; ++i)
+            {
+                func(data_[i], i);
+            }
+        }
+
+        /// @brief Hints to the kernel how the file will be accessed.
+        /// @param advice The expected access pattern.
+        /// @return False if the hint is not supported on this platform.
+        bool advise(MapAdvice advice)
+        {
+            return mapping_.advise(advice);
+        }
+
+        /// @brief Writes modified elements back to the file, and waits until they are written.
+        /// @return False if the write failed.
+        bool flush()
+        {
+            return mapping_.flush();
+        }
+
+        // Range-based for support
+        T *begin() const { return data_; }
+        T *end() const { return data_ + size_; }
+    };
+}
+
+#endif // FENZ_MAPPED_HPP
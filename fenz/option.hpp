@@ -1,6 +1,9 @@
 #ifndef FENZ_OPTION_HPP
 #define FENZ_OPTION_HPP
 
+#include <new>
+#include <utility>
+
 namespace fenz
 {
     /// @brief A simple optional value container, representing either a value or no value.
@@ -23,7 +26,7 @@ namespace fenz
 
         /// @brief Constructs an Option containing a value.
         /// @param value The value to store.
-        Option(T value) : value_(value), hasValue_(true) {}
+        Option(T value) : value_(std::move(value)), hasValue_(true) {}
 
         /// @brief Copy constructor.
         /// @param other The Option to copy from.
@@ -40,6 +43,16 @@ namespace fenz
             }
         }
 
+        /// @brief Move constructor. Allows Options of types that can be moved but not copied.
+        /// @param other The Option to move from. It keeps its value, in a moved-from state.
+        Option(Option &&other) : hasValue_(other.hasValue_)
+        {
+            if (hasValue_)
+            {
+                new (&value_) T(std::move(other.value_));
+            }
+        }
+
         /// @brief Destructor. If a value is present, it's destructor is called.
         ~Option()
         {
@@ -124,6 +137,52 @@ namespace fenz
         }
     };
 
+    /// @brief An optional reference, representing either a reference to an existing object or no value.
+    /// @details Stores a pointer, so it can be returned from lookups without copying the object found.
+    /// @tparam T The type of the referenced object. May be const.
+    template <typename T>
+    class Option<T &>
+    {
+    private:
+        T *value_;
+
+    public:
+        /// @brief Constructs an Option with no value.
+        Option() : value_(nullptr) {}
+
+        /// @brief Constructs an Option referring to an object.
+        /// @param value The object to refer to. It must outlive the Option.
+        Option(T &value) : value_(&value) {}
+
+        /// @brief Checks if the Option refers to an object.
+        /// @return True if a value is present, false otherwise.
+        bool hasValue() const
+        {
+            return value_ != nullptr;
+        }
+
+        /// @brief Implicit conversion to bool, true if a value is present.
+        operator bool() const
+        {
+            return hasValue();
+        }
+
+        /// @brief Returns the referenced object if present, otherwise returns a fallback.
+        /// @param ifNone The object to return if no value is present.
+        /// @return Reference to the referenced object or the fallback.
+        T &valueOr(T &ifNone) const
+        {
+            return hasValue() ? *value_ : ifNone;
+        }
+
+        /// @brief Returns the referenced object.
+        /// @note Calling this when no value is present results in undefined behavior.
+        T &value_unsafely() const
+        {
+            return *value_;
+        }
+    };
+
 }
 
 #endif // FENZ_OPTION_HPP
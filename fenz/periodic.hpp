@@ -0,0 +1,400 @@
+#include "option.hpp"
+#include "priority_queue.hpp"
+#include "time.hpp"
+
+#ifndef FENZ_PERIODIC_HPP
+#define FENZ_PERIODIC_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace fenz
+{
+    /// @brief Identifies a task scheduled on a PeriodicScheduler, for cancelling it or reading its statistics.
+    struct PeriodicHandle
+    {
+        /// The storage slot of the task.
+        unsigned int index;
+        /// Distinguishes this task from earlier and later tasks that used the same slot.
+        unsigned int generation;
+    };
+
+    /// @brief Run-time and lateness statistics of a task on a PeriodicScheduler, at the precision of its Moment type.
+    struct PeriodicTaskStats
+    {
+        /// The number of times the task has run.
+        unsigned long long runs;
+        /// The number of targets that were skipped because the task was running late.
+        unsigned long long skipped;
+        Nanoseconds totalRunTime;
+        Nanoseconds maxRunTime;
+        /// Lateness is how long after its target time a run started.
+        Nanoseconds totalLateness;
+        Nanoseconds maxLateness;
+    };
+
+    /// @brief Runs many periodic and one-shot tasks on a single background thread.
+    /// @details Tasks are kept in a deadline heap. Periodic tasks are scheduled against absolute targets: each target is
+    ///          the previous target plus the period, not the end of the previous run plus the period, so late runs do not
+    ///          accumulate drift. If several targets pass while a task is late, it runs once for the latest of them and
+    ///          the others are skipped and counted. All tasks that are due when the thread wakes up are run in one batch.
+    ///
+    ///          Tasks should be short, since they delay each other. Hand long work off to a `Scheduler`.
+    /// @tparam MaxTasks The maximum number of tasks that can be scheduled at the same time.
+    /// @tparam MomentType The Moment type of targets, which also sets the precision of the statistics.
+    template <unsigned int MaxTasks, typename MomentType = Moment>
+    class PeriodicScheduler
+    {
+        static_assert(MaxTasks > 0, "PeriodicScheduler must hold at least one task");
+
+    public:
+        /// The Duration type matching `MomentType`.
+        typedef decltype(MomentType::now() - MomentType::now()) DurationType;
+
+    private:
+        static constexpr unsigned int None = MaxTasks;
+
+        struct Slot
+        {
+            void (*invoke)(void *);
+            void *context;
+            /// The period in ticks of `MomentType`, or zero for a one-shot task.
+            long long period;
+            unsigned int generation;
+            /// True while the slot holds a task, false while it is in the free list.
+            bool active;
+            unsigned int nextFree;
+
+            unsigned long long runs;
+            unsigned long long skipped;
+            long long totalRunNanos;
+            long long maxRunNanos;
+            long long totalLateNanos;
+            long long maxLateNanos;
+        };
+
+        /// A target time of a task in the heap. Entries of cancelled tasks are left in the heap and skipped when popped.
+        struct Target
+        {
+            long long ticks;
+            unsigned int index;
+            unsigned int generation;
+        };
+
+        struct EarlierTarget
+        {
+            bool operator()(const Target &lhs, const Target &rhs) const
+            {
+                return lhs.ticks < rhs.ticks;
+            }
+        };
+
+        Slot slots_[MaxTasks];
+        PriorityQueue<Target, MaxTasks, EarlierTarget> heap_;
+        /// Due targets of the current batch.
+        Target due_[MaxTasks];
+        /// Live targets kept while the heap is compacted.
+        Target live_[MaxTasks];
+        unsigned int freeHead_;
+        unsigned int count_;
+
+        std::mutex mutex_;
+        /// Signalled when a task is added or the scheduler stops.
+        std::condition_variable changed_;
+        /// Signalled when a task finishes running.
+        std::condition_variable finished_;
+        /// The slot of the task that is running, or `None`.
+        unsigned int running_;
+        bool stopping_;
+        std::thread thread_;
+
+        template <typename Func>
+        static void invoke(void *context)
+        {
+            (*static_cast<Func *>(context))();
+        }
+
+        bool isCurrent(const Target &target) const
+        {
+            return slots_[target.index].active && slots_[target.index].generation == target.generation;
+        }
+
+        void release(unsigned int index)
+        {
+            Slot &slot = slots_[index];
+            slot.active = false;
+            slot.generation++;
+            slot.nextFree = freeHead_;
+            freeHead_ = index;
+            count_--;
+        }
+
+        /// @brief Adds a target to the heap, first dropping the targets of cancelled tasks if the heap is full.
+        void pushTarget(const Target &target)
+        {
+            if (heap_.isFull())
+            {
+                unsigned int live = 0;
+                heap_.popAll([this, &live](const Target &stale)
+                             {
+                                 if (isCurrent(stale))
+                                 {
+                                     live_[live++] = stale;
+                                 } });
+                for (unsigned int i = 0; i < live; ++i)
+                {
+                    heap_.push(live_[i]);
+                }
+            }
+            heap_.push(target);
+        }
+
+        template <typename Func>
+        Option<PeriodicHandle> add(const MomentType &first, long long period, Func &func)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (freeHead_ == None)
+            {
+                return Option<PeriodicHandle>();
+            }
+            unsigned int index = freeHead_;
+            Slot &slot = slots_[index];
+            freeHead_ = slot.nextFree;
+            count_++;
+
+            slot.invoke = &PeriodicScheduler::invoke<Func>;
+            slot.context = const_cast<void *>(static_cast<const void *>(&func));
+            slot.period = period;
+            slot.active = true;
+            slot.runs = 0;
+            slot.skipped = 0;
+            slot.totalRunNanos = 0;
+            slot.maxRunNanos = 0;
+            slot.totalLateNanos = 0;
+            slot.maxLateNanos = 0;
+            pushTarget(Target{first.value, index, slot.generation});
+            changed_.notify_one();
+            return Option<PeriodicHandle>(PeriodicHandle{index, slot.generation});
+        }
+
+        /// @brief Runs one due task and schedules its next run. Called with the lock held.
+        void run(const Target &target, std::unique_lock<std::mutex> &lock)
+        {
+            Slot &slot = slots_[target.index];
+            void (*invokeTask)(void *) = slot.invoke;
+            void *context = slot.context;
+            running_ = target.index;
+            lock.unlock();
+
+            MomentType start = MomentType::now();
+            invokeTask(context);
+            MomentType end = MomentType::now();
+
+            lock.lock();
+            running_ = None;
+            finished_.notify_all();
+            if (!isCurrent(target))
+            {
+                // Cancelled while running
+                return;
+            }
+
+            long long runNanos = (end - start).nanos();
+            long long lateNanos = (start - MomentType::fromTicks(target.ticks)).nanos();
+            lateNanos = lateNanos < 0 ? 0 : lateNanos;
+            slot.runs++;
+            slot.totalRunNanos += runNanos;
+            slot.maxRunNanos = runNanos > slot.maxRunNanos ? runNanos : slot.maxRunNanos;
+            slot.totalLateNanos += lateNanos;
+            slot.maxLateNanos = lateNanos > slot.maxLateNanos ? lateNanos : slot.maxLateNanos;
+
+            if (slot.period == 0)
+            {
+                release(target.index);
+                return;
+            }
+            // If targets have passed while running, run once for the latest of them right away and skip the others
+            long long next = target.ticks + slot.period;
+            if (next < end.value)
+            {
+                long long missed = (end.value - next) / slot.period;
+                slot.skipped += static_cast<unsigned long long>(missed);
+                next += missed * slot.period;
+            }
+            pushTarget(Target{next, target.index, target.generation});
+        }
+
+        void loop()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stopping_)
+            {
+                Option<Target> top = heap_.peek();
+                if (!top.hasValue())
+                {
+                    changed_.wait(lock);
+                    continue;
+                }
+                if (!isCurrent(top.value_unsafely()))
+                {
+                    heap_.pop();
+                    continue;
+                }
+
+                MomentType now = MomentType::now();
+                if (top.value_unsafely().ticks > now.value)
+                {
+                    changed_.wait_for(lock, std::chrono::nanoseconds((MomentType::fromTicks(top.value_unsafely().ticks) - now).nanos()));
+                    continue;
+                }
+
+                // Take the whole batch of due targets first, so that targets rescheduled by this batch wait for the next one
+                unsigned int dueCount = 0;
+                while (!heap_.isEmpty() && heap_.peek().value_unsafely().ticks <= now.value)
+                {
+                    due_[dueCount++] = heap_.pop().value_unsafely();
+                }
+                for (unsigned int i = 0; i < dueCount && !stopping_; ++i)
+                {
+                    Target target = due_[i];
+                    if (isCurrent(target))
+                    {
+                        run(target, lock);
+                    }
+                }
+            }
+        }
+
+    public:
+        /// @brief Constructs a PeriodicScheduler and starts its thread.
+        PeriodicScheduler() : freeHead_(0), count_(0), running_(None), stopping_(false)
+        {
+            for (unsigned int i = 0; i < MaxTasks; ++i)
+            {
+                slots_[i].generation = 0;
+                slots_[i].active = false;
+                slots_[i].nextFree = i + 1;
+            }
+            thread_ = std::thread(&PeriodicScheduler::loop, this);
+        }
+
+        /// @brief Destructor. Stops the thread after the running task, if any, finishes. Remaining tasks do not run.
+        ~PeriodicScheduler()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            changed_.notify_one();
+            thread_.join();
+        }
+
+        PeriodicScheduler(const PeriodicScheduler &) = delete;
+        PeriodicScheduler &operator=(const PeriodicScheduler &) = delete;
+
+        /// @brief Schedules a task to run every period, starting one period from now.
+        /// @param period The time between the targets of consecutive runs. Must be positive.
+        /// @param func The task, called with no arguments. Not copied: it must stay alive until the task is cancelled.
+        /// @return An Option containing the handle of the task, or an empty Option if the scheduler is full.
+        template <typename Func>
+        Option<PeriodicHandle> every(const DurationType &period, Func &func)
+        {
+            return add(MomentType::now() + period, period.count(), func);
+        }
+
+        /// @brief Schedules a task to run every period, starting at a given time.
+        /// @param first The target of the first run.
+        /// @param period The time between the targets of consecutive runs. Must be positive.
+        /// @param func The task, called with no arguments. Not copied: it must stay alive until the task is cancelled.
+        /// @return An Option containing the handle of the task, or an empty Option if the scheduler is full.
+        template <typename Func>
+        Option<PeriodicHandle> every(const MomentType &first, const DurationType &period, Func &func)
+        {
+            return add(first, period.count(), func);
+        }
+
+        /// @brief Schedules a task to run once at a given time.
+        /// @param deadline The target of the run. Targets that have passed run as soon as possible.
+        /// @param func The task, called with no arguments. Not copied: it must stay alive until it has run or is cancelled.
+        /// @return An Option containing the handle of the task, or an empty Option if the scheduler is full.
+        template <typename Func>
+        Option<PeriodicHandle> at(const MomentType &deadline, Func &func)
+        {
+            return add(deadline, 0, func);
+        }
+
+        /// @brief Schedules a task to run once after a delay.
+        /// @param delay How long from now the task runs.
+        /// @param func The task, called with no arguments. Not copied: it must stay alive until it has run or is cancelled.
+        /// @return An Option containing the handle of the task, or an empty Option if the scheduler is full.
+        template <typename Func>
+        Option<PeriodicHandle> after(const DurationType &delay, Func &func)
+        {
+            return add(MomentType::now() + delay, 0, func);
+        }
+
+        /// @brief Cancels a task. If the task is running on the scheduler's thread, waits for it to finish, unless called
+        ///        from the task itself.
+        /// @param handle The handle returned when the task was scheduled.
+        /// @return True if the task was cancelled, false if it already finished or was cancelled.
+        bool cancel(const PeriodicHandle &handle)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (handle.index >= MaxTasks || !isCurrent(Target{0, handle.index, handle.generation}))
+            {
+                return false;
+            }
+            release(handle.index);
+            if (std::this_thread::get_id() != thread_.get_id())
+            {
+                finished_.wait(lock, [this, &handle]
+                               { return running_ != handle.index; });
+            }
+            return true;
+        }
+
+        /// @brief Checks if a task is still scheduled.
+        /// @param handle The handle returned when the task was scheduled.
+        /// @return True if the task has neither finished nor been cancelled.
+        bool isScheduled(const PeriodicHandle &handle)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return handle.index < MaxTasks && isCurrent(Target{0, handle.index, handle.generation});
+        }
+
+        /// @brief Returns the statistics of a scheduled task.
+        /// @param handle The handle returned when the task was scheduled.
+        /// @return An Option containing the statistics, or an empty Option if the task has finished or was cancelled.
+        Option<PeriodicTaskStats> stats(const PeriodicHandle &handle)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (handle.index >= MaxTasks || !isCurrent(Target{0, handle.index, handle.generation}))
+            {
+                return Option<PeriodicTaskStats>();
+            }
+            const Slot &slot = slots_[handle.index];
+            return Option<PeriodicTaskStats>(PeriodicTaskStats{slot.runs, slot.skipped,
+                                                               Nanoseconds::fromNanos(slot.totalRunNanos), Nanoseconds::fromNanos(slot.maxRunNanos),
+                                                               Nanoseconds::fromNanos(slot.totalLateNanos), Nanoseconds::fromNanos(slot.maxLateNanos)});
+        }
+
+        /// @brief Returns the number of scheduled tasks.
+        /// @return The number of scheduled tasks.
+        unsigned int size()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return count_;
+        }
+
+        /// @brief Returns the maximum number of tasks.
+        /// @return The maximum number of tasks.
+        constexpr unsigned int capacity() const
+        {
+            return MaxTasks;
+        }
+    };
+}
+
+#endif // FENZ_PERIODIC_HPP
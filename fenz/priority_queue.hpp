@@ -0,0 +1,204 @@
+#include "array.hpp"
+#include "functional.hpp"
+#include "option.hpp"
+
+#ifndef FENZ_PRIORITY_QUEUE_HPP
+#define FENZ_PRIORITY_QUEUE_HPP
+
+namespace fenz
+{
+    /// @brief A priority queue with a max capacity, stored inline as a 4-ary heap.
+    /// @details Each node has four children stored next to each other, so for small elements a node's children
+    ///          share one cache line and the heap is half as deep as a binary heap.
+    /// @tparam T The type of elements in the queue. Must be default constructible.
+    /// @tparam Capacity The maximum number of elements the queue can hold.
+    /// @tparam Compare A callable taking `(const T&, const T&)`, returning true if the first element should be
+    ///         removed before the second. With the default `Less<T>` the smallest element is removed first.
+    template <typename T, unsigned int Capacity, typename Compare = Less<T>>
+    class PriorityQueue
+    {
+        static_assert(Capacity > 0, "PriorityQueue capacity must be greater than zero");
+
+    private:
+        T data_[Capacity];
+        unsigned int count_;
+        Compare compare_;
+
+        /// @brief Moves the item at `index` towards the root until its parent does not come after it.
+        void siftUp(unsigned int index)
+        {
+            T item = data_[index];
+            while (index > 0)
+            {
+                unsigned int parent = (index - 1) / 4;
+                if (!compare_(item, data_[parent]))
+                {
+                    break;
+                }
+                data_[index] = data_[parent];
+                index = parent;
+            }
+            data_[index] = item;
+        }
+
+        /// @brief Moves the item at `index` towards the leaves until none of its children come before it.
+        void siftDown(unsigned int index)
+        {
+            T item = data_[index];
+            while (true)
+            {
+                unsigned int first = index * 4 + 1;
+                if (first >= count_)
+                {
+                    break;
+                }
+                unsigned int last = first + 4 < count_ ? first + 4 : count_;
+                unsigned int best = first;
+                for (unsigned int child = first + 1; child < last; ++child)
+                {
+                    if (compare_(data_[child], data_[best]))
+                    {
+                        best = child;
+                    }
+                }
+                if (!compare_(data_[best], item))
+                {
+                    break;
+                }
+                data_[index] = data_[best];
+                index = best;
+            }
+            data_[index] = item;
+        }
+
+    public:
+        /// @brief Constructs an empty PriorityQueue.
+        /// @param compare The comparison function to order elements with.
+        PriorityQueue(Compare compare = Compare()) : count_(0), compare_(compare) {}
+
+        /// @brief Adds an item to the queue.
+        /// @return True if the item was added, false if the queue is full.
+        /// @param item The item to add.
+        bool push(const T &item)
+        {
+            if (isFull())
+            {
+                return false;
+            }
+            data_[count_] = item;
+            siftUp(count_);
+            count_++;
+            return true;
+        }
+
+        /// @brief Removes and returns the item that comes first in the queue.
+        /// @return An Option containing the item if the queue is not empty, or an empty Option if the queue is empty.
+        Option<T> pop()
+        {
+            if (isEmpty())
+            {
+                return Option<T>();
+            }
+            Option<T> item = data_[0];
+            count_--;
+            if (count_ > 0)
+            {
+                data_[0] = data_[count_];
+                siftDown(0);
+            }
+            return item;
+        }
+
+        /// @brief Returns the item that comes first in the queue without removing it.
+        /// @return An Option containing the item if the queue is not empty, or an empty Option if the queue is empty.
+        Option<T> peek() const
+        {
+            if (isEmpty())
+            {
+                return Option<T>();
+            }
+            return Option<T>(data_[0]);
+        }
+
+        /// @brief Adds all items of an Iterable to the queue at once.
+        /// @details The items are appended and the heap is rebuilt bottom-up, which takes O(n) time
+        ///          instead of the O(n log n) of pushing them one by one.
+        /// @tparam U The element type of the Iterable, convertible to `T`.
+        /// @tparam N The number of items to add.
+        /// @param items The items to add.
+        /// @return True if the items were added, false if they do not fit, in which case the queue is unchanged.
+        template <typename U, int N>
+        bool heapify(const Iterable<U, N> &items)
+        {
+            static_assert(static_cast<unsigned int>(N) <= Capacity, "Iterable is larger than the queue capacity");
+
+            if (Capacity - count_ < static_cast<unsigned int>(N))
+            {
+                return false;
+            }
+            for (const U &item : items)
+            {
+                data_[count_++] = item;
+            }
+            if (count_ > 1)
+            {
+                for (unsigned int index = (count_ - 2) / 4 + 1; index-- > 0;)
+                {
+                    siftDown(index);
+                }
+            }
+            return true;
+        }
+
+        /// @brief Pops all items from the queue in order, calling the provided function for each item.
+        /// @param func The function to call for each item. This function should take a single argument of type that this queue holds.
+        template <typename Func>
+        void popAll(Func func)
+        {
+            while (!isEmpty())
+            {
+                Option<T> item = pop();
+                if (item.hasValue())
+                {
+                    func(item.value_unsafely());
+                }
+            }
+        }
+
+        /// @brief Removes all items from the queue.
+        void clear()
+        {
+            count_ = 0;
+        }
+
+        /// @brief Returns the number of elements in the queue.
+        /// @return The number of elements in the queue.
+        constexpr unsigned int size() const
+        {
+            return count_;
+        }
+
+        /// @brief Returns the maximum capacity of the queue.
+        /// @return The maximum capacity of the queue.
+        constexpr unsigned int capacity() const
+        {
+            return Capacity;
+        }
+
+        /// @brief Checks if the queue is full.
+        /// @return True if the queue is full, false otherwise.
+        bool isFull() const
+        {
+            return count_ == Capacity;
+        }
+
+        /// @brief Checks if the queue is empty.
+        /// @return True if the queue is empty, false otherwise.
+        bool isEmpty() const
+        {
+            return count_ == 0;
+        }
+    };
+}
+
+#endif // FENZ_PRIORITY_QUEUE_HPP
@@ -0,0 +1,492 @@
+#include "option.hpp"
+#include "time.hpp"
+
+#ifndef FENZ_PROFILER_HPP
+#define FENZ_PROFILER_HPP
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+/// The number of zone events each thread's ring buffer holds before the oldest are overwritten. Must be a power of two.
+#ifndef FENZ_PROFILE_BUFFER_CAPACITY
+#define FENZ_PROFILE_BUFFER_CAPACITY 4096
+#endif
+
+namespace fenz
+{
+    /// @brief One completed execution of a profiled zone.
+    struct ZoneEvent
+    {
+        /// The name passed to `FENZ_ZONE`.
+        const char *name;
+        /// When the zone was entered.
+        NanoMoment start;
+        /// When the zone was exited.
+        NanoMoment end;
+        /// Identifies the thread that executed the zone. Threads that have exited pass their id on to later threads.
+        unsigned int thread;
+    };
+
+    namespace detail
+    {
+        /// @brief A single-writer ring buffer of zone events that overwrites the oldest event when full, like
+        ///        `Queue::forceEnqueue`, and can be read concurrently by a collector.
+        /// @details Each slot is guarded by a sequence number in the style of a seqlock, so that a collector never
+        ///          returns an event that the owning thread was overwriting while it was read.
+        class ZoneBuffer
+        {
+            static_assert((FENZ_PROFILE_BUFFER_CAPACITY & (FENZ_PROFILE_BUFFER_CAPACITY - 1)) == 0 && FENZ_PROFILE_BUFFER_CAPACITY > 0,
+                          "FENZ_PROFILE_BUFFER_CAPACITY must be a power of two");
+
+        private:
+            static constexpr unsigned long long Capacity = FENZ_PROFILE_BUFFER_CAPACITY;
+
+            struct Slot
+            {
+                /// The index of the event in the slot plus one, or zero while it is being written.
+                std::atomic<unsigned long long> sequence;
+                std::atomic<const char *> name;
+                std::atomic<long long> start;
+                std::atomic<long long> end;
+            };
+
+            Slot slots_[Capacity];
+            /// The number of events ever written. Only written by the owning thread.
+            std::atomic<unsigned long long> head_;
+            /// The index of the next event to collect. Only used by the collector.
+            unsigned long long cursor_;
+
+        public:
+            /// The next buffer in the registry. Never changes once the buffer is registered.
+            ZoneBuffer *next;
+            const unsigned int id;
+            /// True while a thread owns the buffer.
+            std::atomic<bool> claimed;
+
+            ZoneBuffer(ZoneBuffer *nextBuffer, unsigned int bufferId)
+                : head_(0), cursor_(0), next(nextBuffer), id(bufferId), claimed(true)
+            {
+                for (unsigned long long i = 0; i < Capacity; ++i)
+                {
+                    slots_[i].sequence.store(0, std::memory_order_relaxed);
+                }
+            }
+
+            /// @brief Appends an event. Only called by the owning thread.
+            void record(const char *name, const NanoMoment &start, const NanoMoment &end)
+            {
+                unsigned long long index = head_.load(std::memory_order_relaxed);
+                Slot &slot = slots_[index & (Capacity - 1)];
+                slot.sequence.store(0, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.name.store(name, std::memory_order_relaxed);
+                slot.start.store(start.value, std::memory_order_relaxed);
+                slot.end.store(end.value, std::memory_order_relaxed);
+                slot.sequence.store(index + 1, std::memory_order_release);
+                head_.store(index + 1, std::memory_order_release);
+            }
+
+            /// @brief Reads all events written since the last call, in order. Only called by one collector at a time.
+            /// @return The number of events that were overwritten before they could be read.
+            template <typename Func>
+            unsigned long long drain(Func &func)
+            {
+                unsigned long long head = head_.load(std::memory_order_acquire);
+                unsigned long long dropped = 0;
+                if (head - cursor_ > Capacity)
+                {
+                    dropped = head - Capacity - cursor_;
+                    cursor_ = head - Capacity;
+                }
+                for (; cursor_ < head; ++cursor_)
+                {
+                    Slot &slot = slots_[cursor_ & (Capacity - 1)];
+                    unsigned long long before = slot.sequence.load(std::memory_order_acquire);
+                    ZoneEvent event = {slot.name.load(std::memory_order_relaxed),
+                                       NanoMoment::fromTicks(slot.start.load(std::memory_order_relaxed)),
+                                       NanoMoment::fromTicks(slot.end.load(std::memory_order_relaxed)),
+                                       id};
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (before != cursor_ + 1 || slot.sequence.load(std::memory_order_relaxed) != before)
+                    {
+                        // Overwritten by the owning thread since `head` was read
+                        dropped++;
+                        continue;
+                    }
+                    func(static_cast<const ZoneEvent &>(event));
+                }
+                return dropped;
+            }
+        };
+
+        /// @brief The list of all zone buffers ever created. Buffers are never freed, so that events recorded by threads that
+        ///        have exited can still be collected, and are reused by later threads.
+        struct ZoneRegistry
+        {
+            std::atomic<ZoneBuffer *> head;
+            std::atomic<unsigned int> count;
+        };
+
+        inline ZoneRegistry &zoneRegistry()
+        {
+            static ZoneRegistry registry = {{nullptr}, {0}};
+            return registry;
+        }
+
+        /// @brief Gives the calling thread's buffer back to the registry when the thread exits.
+        struct ZoneBufferRelease
+        {
+            ZoneBuffer *buffer;
+
+            ~ZoneBufferRelease()
+            {
+                buffer->claimed.store(false, std::memory_order_release);
+            }
+        };
+
+        inline ZoneBuffer *&threadZoneBufferSlot()
+        {
+            static thread_local ZoneBuffer *buffer = nullptr;
+            return buffer;
+        }
+
+        /// @brief Claims a released buffer, or creates and registers a new one.
+        inline ZoneBuffer *claimZoneBuffer()
+        {
+            ZoneRegistry &registry = zoneRegistry();
+            ZoneBuffer *buffer = registry.head.load(std::memory_order_acquire);
+            for (; buffer != nullptr; buffer = buffer->next)
+            {
+                bool released = false;
+                if (!buffer->claimed.load(std::memory_order_relaxed) &&
+                    buffer->claimed.compare_exchange_strong(released, true, std::memory_order_acquire))
+                {
+                    break;
+                }
+            }
+            if (buffer == nullptr)
+            {
+                ZoneBuffer *head = registry.head.load(std::memory_order_relaxed);
+                buffer = new ZoneBuffer(head, registry.count.fetch_add(1, std::memory_order_relaxed));
+                while (!registry.head.compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed))
+                {
+                    buffer->next = head;
+                }
+            }
+
+            static thread_local ZoneBufferRelease release = {buffer};
+            threadZoneBufferSlot() = buffer;
+            return buffer;
+        }
+
+        /// @brief Returns the calling thread's buffer.
+        inline ZoneBuffer &threadZoneBuffer()
+        {
+            ZoneBuffer *buffer = threadZoneBufferSlot();
+            return buffer != nullptr ? *buffer : *claimZoneBuffer();
+        }
+    }
+
+    /// @brief Records the time between its construction and destruction as a zone event of the calling thread.
+    /// @details Usually used through `FENZ_ZONE`, which compiles away unless `FENZ_PROFILE` is defined.
+    ///          Costs two reads of the nanosecond time source and a handful of stores.
+    class ProfileZone
+    {
+    private:
+        const char *name_;
+        NanoMoment start_;
+
+    public:
+        /// @brief Enters a zone.
+        /// @param name The name of the zone. Must outlive all collection, so is usually a string literal.
+        explicit ProfileZone(const char *name) : name_(name), start_(NanoMoment::now()) {}
+
+        /// @brief Exits the zone and records it.
+        ~ProfileZone()
+        {
+            NanoMoment end = NanoMoment::now();
+            detail::threadZoneBuffer().record(name_, start_, end);
+        }
+
+        ProfileZone(const ProfileZone &) = delete;
+        ProfileZone &operator=(const ProfileZone &) = delete;
+    };
+
+    /// @brief Reads all zone events recorded by all threads since the last call.
+    /// @details Threads keep recording while events are read. Only one thread may collect at a time.
+    /// @param func The function to call for each event. This function should take a single argument of type `const ZoneEvent&`.
+    ///        Events of the same thread are passed in order.
+    /// @return The number of events that were overwritten before they could be read. If this is not zero, collect more
+    ///         often or increase `FENZ_PROFILE_BUFFER_CAPACITY`.
+    template <typename Func>
+    unsigned long long collectZoneEvents(Func func)
+    {
+        unsigned long long dropped = 0;
+        for (detail::ZoneBuffer *buffer = detail::zoneRegistry().head.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next)
+        {
+            dropped += buffer->drain(func);
+        }
+        return dropped;
+    }
+
+    /// @brief Statistics of all executions of one zone.
+    struct ZoneStats
+    {
+        const char *name;
+        unsigned long long count;
+        Nanoseconds total;
+        Nanoseconds min;
+        Nanoseconds max;
+
+        /// @brief Returns the mean time spent in the zone.
+        /// @return The mean time, or zero if the zone never executed.
+        Nanoseconds mean() const
+        {
+            return count == 0 ? Nanoseconds::fromNanos(0) : Nanoseconds::fromNanos(total.nanos() / static_cast<long long>(count));
+        }
+    };
+
+    /// @brief Aggregates zone events into per-zone statistics.
+    /// @details Zones are identified by name, so zones with the same name in different places are aggregated together.
+    /// @tparam MaxZones The maximum number of distinct zone names. Events of further zones are counted by `untracked()`.
+    template <unsigned int MaxZones = 256>
+    class ZoneCollector
+    {
+        static_assert(MaxZones > 0, "ZoneCollector must track at least one zone");
+
+    private:
+        static constexpr unsigned int TableSize = MaxZones * 2;
+
+        struct Entry
+        {
+            /// The name of the zone, or null if the entry is empty.
+            const char *name;
+            unsigned long long count;
+            long long totalNanos;
+            long long minNanos;
+            long long maxNanos;
+
+            ZoneStats stats() const
+            {
+                return ZoneStats{name, count, Nanoseconds::fromNanos(totalNanos), Nanoseconds::fromNanos(minNanos), Nanoseconds::fromNanos(maxNanos)};
+            }
+        };
+
+        Entry entries_[TableSize];
+        unsigned int zones_;
+        unsigned long long dropped_;
+        unsigned long long untracked_;
+
+        static unsigned int hashName(const char *name)
+        {
+            // FNV-1a
+            unsigned int hash = 2166136261u;
+            for (; *name != '\0'; ++name)
+            {
+                hash = (hash ^ static_cast<unsigned char>(*name)) * 16777619u;
+            }
+            return hash;
+        }
+
+        /// @brief Returns the table entry of a name, or the empty entry where it belongs.
+        unsigned int slotOf(const char *name) const
+        {
+            unsigned int slot = hashName(name) % TableSize;
+            while (entries_[slot].name != nullptr && entries_[slot].name != name && std::strcmp(entries_[slot].name, name) != 0)
+            {
+                slot = (slot + 1) % TableSize;
+            }
+            return slot;
+        }
+
+        void add(const ZoneEvent &event)
+        {
+            unsigned int slot = slotOf(event.name);
+            Entry &entry = entries_[slot];
+            long long elapsed = (event.end - event.start).nanos();
+            if (entry.name == nullptr)
+            {
+                if (zones_ == MaxZones)
+                {
+                    untracked_++;
+                    return;
+                }
+                zones_++;
+                entry.name = event.name;
+                entry.count = 0;
+                entry.totalNanos = 0;
+                entry.minNanos = elapsed;
+                entry.maxNanos = elapsed;
+            }
+            entry.count++;
+            entry.totalNanos += elapsed;
+            entry.minNanos = elapsed < entry.minNanos ? elapsed : entry.minNanos;
+            entry.maxNanos = elapsed > entry.maxNanos ? elapsed : entry.maxNanos;
+        }
+
+    public:
+        /// @brief Constructs a ZoneCollector with no statistics.
+        ZoneCollector()
+        {
+            reset();
+        }
+
+        /// @brief Collects all zone events recorded since the last collection and adds them to the statistics.
+        /// @return The number of events collected.
+        unsigned long long collect()
+        {
+            return collect([](const ZoneEvent &) {});
+        }
+
+        /// @brief Collects all zone events recorded since the last collection, adds them to the statistics and passes them on,
+        ///        e.g. to `ChromeTraceWriter::write`.
+        /// @param func The function to call for each event. This function should take a single argument of type `const ZoneEvent&`.
+        /// @return The number of events collected.
+        template <typename Func>
+        unsigned long long collect(Func func)
+        {
+            unsigned long long collected = 0;
+            dropped_ += collectZoneEvents([this, &func, &collected](const ZoneEvent &event)
+                                          {
+                                              add(event);
+                                              func(event);
+                                              collected++; });
+            return collected;
+        }
+
+        /// @brief Returns the statistics of a zone.
+        /// @param name The name of the zone.
+        /// @return An Option containing the statistics, or an empty Option if the zone has not been collected.
+        Option<ZoneStats> find(const char *name) const
+        {
+            const Entry &entry = entries_[slotOf(name)];
+            return entry.name == nullptr ? Option<ZoneStats>() : Option<ZoneStats>(entry.stats());
+        }
+
+        /// @brief Calls a function with the statistics of each zone, in no particular order.
+        /// @param func The function to call. This function should take a single argument of type `const ZoneStats&`.
+        template <typename Func>
+        void forEach(Func func) const
+        {
+            for (unsigned int slot = 0; slot < TableSize; ++slot)
+            {
+                if (entries_[slot].name != nullptr)
+                {
+                    func(static_cast<const ZoneStats &>(entries_[slot].stats()));
+                }
+            }
+        }
+
+        /// @brief Returns the number of distinct zones collected.
+        /// @return The number of zones.
+        unsigned int size() const
+        {
+            return zones_;
+        }
+
+        /// @brief Returns the number of events that were overwritten in a thread's buffer before they could be collected.
+        /// @return The number of lost events.
+        unsigned long long dropped() const
+        {
+            return dropped_;
+        }
+
+        /// @brief Returns the number of events of zones beyond `MaxZones`, which are not in the statistics.
+        /// @return The number of untracked events.
+        unsigned long long untracked() const
+        {
+            return untracked_;
+        }
+
+        /// @brief Clears all statistics.
+        void reset()
+        {
+            for (unsigned int slot = 0; slot < TableSize; ++slot)
+            {
+                entries_[slot].name = nullptr;
+            }
+            zones_ = 0;
+            dropped_ = 0;
+            untracked_ = 0;
+        }
+    };
+
+    /// @brief Writes zone events to a file in the Chrome trace event format, for viewing in `chrome://tracing` or Perfetto.
+    /// @details The JSON document is opened on construction and closed on destruction. Timestamps are relative to the start
+    ///          of the first event written.
+    class ChromeTraceWriter
+    {
+    private:
+        FILE *file_;
+        bool first_;
+        /// The start of the first event, in nanoseconds.
+        long long origin_;
+
+        void writeName(const char *name)
+        {
+            std::fputc('"', file_);
+            for (; *name != '\0'; ++name)
+            {
+                if (*name == '"' || *name == '\\')
+                {
+                    std::fputc('\\', file_);
+                }
+                if (static_cast<unsigned char>(*name) >= 0x20)
+                {
+                    std::fputc(*name, file_);
+                }
+            }
+            std::fputc('"', file_);
+        }
+
+    public:
+        /// @brief Starts a trace.
+        /// @param file The file to write to, which must be open for writing. It is not closed by the writer.
+        explicit ChromeTraceWriter(FILE *file) : file_(file), first_(true), origin_(0)
+        {
+            std::fputs("{\"traceEvents\":[", file_);
+        }
+
+        /// @brief Finishes the trace.
+        ~ChromeTraceWriter()
+        {
+            std::fputs("\n]}\n", file_);
+            std::fflush(file_);
+        }
+
+        ChromeTraceWriter(const ChromeTraceWriter &) = delete;
+        ChromeTraceWriter &operator=(const ChromeTraceWriter &) = delete;
+
+        /// @brief Writes one event as a complete ("X") trace event.
+        /// @param event The event to write.
+        void write(const ZoneEvent &event)
+        {
+            if (first_)
+            {
+                origin_ = event.start.value;
+            }
+            std::fputs(first_ ? "\n" : ",\n", file_);
+            first_ = false;
+            std::fputs("{\"name\":", file_);
+            writeName(event.name);
+            std::fprintf(file_, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                         static_cast<double>(event.start.value - origin_) / 1000.0,
+                         static_cast<double>((event.end - event.start).nanos()) / 1000.0,
+                         event.thread);
+        }
+    };
+}
+
+#define FENZ_ZONE_CONCAT_INNER(a, b) a##b
+#define FENZ_ZONE_CONCAT(a, b) FENZ_ZONE_CONCAT_INNER(a, b)
+
+/// @brief Profiles the rest of the enclosing scope as a zone with the given name.
+/// @note Expands to nothing unless `FENZ_PROFILE` is defined.
+#if defined(FENZ_PROFILE)
+#define FENZ_ZONE(name) ::fenz::ProfileZone FENZ_ZONE_CONCAT(fenzZone, __LINE__)(name)
+#else
+#define FENZ_ZONE(name) static_cast<void>(0)
+#endif
+
+#endif // FENZ_PROFILER_HPP
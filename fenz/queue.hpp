@@ -77,6 +77,19 @@ namespace fenz
             }
         }
 
+        /// @brief Performs an operation on each item, from the front of the queue to the back, without removing it.
+        /// @param func A callable taking `(const T&, int)` — the item and its position relative to the front.
+        template <typename Func>
+        void enumerate(Func func) const
+        {
+            unsigned int index = front;
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                func(data[index].value_unsafely(), static_cast<int>(i));
+                index = index + 1 == Capacity ? 0 : index + 1;
+            }
+        }
+
         /// @brief Returns the number of elements in the queue.
         /// @return The number of elements in the queue.
         constexpr unsigned int size() const
@@ -0,0 +1,298 @@
+#include "option.hpp"
+#include "time.hpp"
+
+#ifndef FENZ_RATE_LIMIT_HPP
+#define FENZ_RATE_LIMIT_HPP
+
+#include <atomic>
+
+namespace fenz
+{
+    namespace detail
+    {
+        /// @brief The generic cell rate algorithm, which tracks a rate limit with a single timestamp: the theoretical
+        ///        arrival time (TAT) at which the limiter would be empty again if nothing more were admitted.
+        /// @details All times are in nanoseconds since `origin`, so that limiters of coarse Moments stay exact.
+        template <typename MomentType>
+        class Gcra
+        {
+        public:
+            typedef decltype(MomentType::now() - MomentType::now()) DurationType;
+
+        private:
+            /// The number of fractional bits of `interval_`.
+            static constexpr int FractionBits = 16;
+
+            MomentType origin_;
+            /// The time one token takes to refill, in 1/65536ths of a nanosecond, so that rates above one token per
+            /// nanosecond still limit.
+            long long interval_;
+            unsigned long long burst_;
+            /// How far ahead of the current time the TAT may run, in nanoseconds.
+            long long limit_;
+            std::atomic<long long> arrival_;
+
+            static long long intervalFor(unsigned long long tokens, const DurationType &period)
+            {
+                long long perToken = static_cast<long long>(tokens == 0 ? 1 : tokens);
+                long long nanos = period.nanos();
+                long long interval = (nanos / perToken << FractionBits) + ((nanos % perToken) << FractionBits) / perToken;
+                return interval > 0 ? interval : 1;
+            }
+
+        public:
+            /// @param tokens The number of tokens per `period`. Zero is treated as one.
+            Gcra(unsigned long long tokens, const DurationType &period, unsigned long long limit, const MomentType &start)
+                : origin_(start),
+                  interval_(intervalFor(tokens, period)),
+                  burst_(limit),
+                  limit_(cost(limit)),
+                  arrival_(0)
+            {
+            }
+
+            /// @brief Returns the time `count` tokens take to refill, in nanoseconds, rounded up.
+            long long cost(unsigned long long count) const
+            {
+                const long long fraction = (1LL << FractionBits) - 1;
+                long long tokens = static_cast<long long>(count);
+                return tokens * (interval_ >> FractionBits) + ((tokens * (interval_ & fraction) + fraction) >> FractionBits);
+            }
+
+            unsigned long long burst() const
+            {
+                return burst_;
+            }
+
+            long long limit() const
+            {
+                return limit_;
+            }
+
+            /// @brief Returns the number of whole tokens that refill in `nanos` nanoseconds, at most the burst.
+            unsigned long long tokensIn(long long nanos) const
+            {
+                if (nanos <= 0)
+                {
+                    return 0;
+                }
+                double estimate = static_cast<double>(nanos) * static_cast<double>(1LL << FractionBits) / static_cast<double>(interval_);
+                unsigned long long tokens = estimate >= static_cast<double>(burst_) ? burst_ : static_cast<unsigned long long>(estimate);
+                while (tokens > 0 && cost(tokens) > nanos)
+                {
+                    tokens--;
+                }
+                return tokens;
+            }
+
+            long long elapsed(const MomentType &now) const
+            {
+                return (now - origin_).nanos();
+            }
+
+            /// @brief Returns the TAT, or the current time if the limiter is idle.
+            long long earliest(long long now) const
+            {
+                long long arrival = arrival_.load(std::memory_order_relaxed);
+                return arrival > now ? arrival : now;
+            }
+
+            /// @brief Reserves `cost` nanoseconds if the TAT would then be at most `allowed` ahead of `now`.
+            /// @param start Set to the TAT before the reservation, or the current time if the limiter was idle.
+            /// @return True if the reservation was made.
+            bool reserve(long long now, long long cost, long long allowed, long long &start)
+            {
+                long long arrival = arrival_.load(std::memory_order_relaxed);
+                while (true)
+                {
+                    start = arrival > now ? arrival : now;
+                    if (start + cost - now > allowed)
+                    {
+                        return false;
+                    }
+                    if (arrival_.compare_exchange_weak(arrival, start + cost, std::memory_order_relaxed))
+                    {
+                        return true;
+                    }
+                }
+            }
+
+            /// @brief Converts nanoseconds to a Duration, rounding up so that callers never proceed too early.
+            static DurationType toDuration(long long nanos)
+            {
+                const long long tick = DurationType::fromTicks(1).nanos();
+                return DurationType::fromTicks(nanos <= 0 ? 0 : (nanos + tick - 1) / tick);
+            }
+        };
+    }
+
+    /// @brief A token bucket rate limiter, which allows bursts of up to `burst` tokens and refills at a steady rate.
+    /// @details Implemented with the generic cell rate algorithm, so the whole state is one timestamp. `tryAcquire` is a
+    ///          lock-free compare-and-swap loop on that timestamp, and one instance can be shared by many threads.
+    ///          The bucket starts full.
+    /// @tparam MomentType The Moment type read by the overloads without a `now` argument.
+    template <typename MomentType = Moment>
+    class TokenBucket
+    {
+    public:
+        /// The Duration type matching `MomentType`.
+        typedef typename detail::Gcra<MomentType>::DurationType DurationType;
+
+    private:
+        detail::Gcra<MomentType> gcra_;
+
+    public:
+        /// @brief Constructs a full TokenBucket.
+        /// @param tokens The number of tokens refilled every `period`. Zero is treated as one.
+        /// @param period The time in which `tokens` tokens are refilled. The time per token is kept to 1/65536 of a
+        ///        nanosecond, and the time for each acquisition is rounded up to a whole nanosecond, so rates above one
+        ///        token per nanosecond are only reached by acquiring several tokens at once.
+        /// @param burst The maximum number of tokens in the bucket.
+        /// @param start The Moment to measure time from.
+        TokenBucket(unsigned long long tokens, const DurationType &period, unsigned long long burst, const MomentType &start = MomentType::now())
+            : gcra_(tokens, period, burst, start)
+        {
+        }
+
+        TokenBucket(const TokenBucket &) = delete;
+        TokenBucket &operator=(const TokenBucket &) = delete;
+
+        /// @brief Takes tokens from the bucket if enough are available.
+        /// @param count The number of tokens to take.
+        /// @param now The current Moment.
+        /// @return True if the tokens were taken, false if not enough are available. Nothing is taken on failure.
+        bool tryAcquire(unsigned long long count, const MomentType &now)
+        {
+            long long start;
+            return gcra_.reserve(gcra_.elapsed(now), gcra_.cost(count), gcra_.limit(), start);
+        }
+
+        /// @brief Takes tokens from the bucket if enough are available, reading the current time from `MomentType::now()`.
+        /// @param count The number of tokens to take.
+        /// @return True if the tokens were taken, false if not enough are available.
+        bool tryAcquire(unsigned long long count = 1)
+        {
+            return tryAcquire(count, MomentType::now());
+        }
+
+        /// @brief Returns how long until enough tokens are available.
+        /// @param count The number of tokens wanted.
+        /// @param now The current Moment.
+        /// @return The time until `tryAcquire(count)` can succeed, or zero if it can now. Rounded up to a whole tick.
+        /// @note Another thread may take the tokens first.
+        DurationType timeUntilAvailable(unsigned long long count, const MomentType &now) const
+        {
+            long long elapsed = gcra_.elapsed(now);
+            return detail::Gcra<MomentType>::toDuration(gcra_.earliest(elapsed) + gcra_.cost(count) - gcra_.limit() - elapsed);
+        }
+
+        /// @brief Returns how long until enough tokens are available, reading the current time from `MomentType::now()`.
+        /// @param count The number of tokens wanted.
+        /// @return The time until `tryAcquire(count)` can succeed, or zero if it can now.
+        DurationType timeUntilAvailable(unsigned long long count = 1) const
+        {
+            return timeUntilAvailable(count, MomentType::now());
+        }
+
+        /// @brief Returns the number of tokens currently in the bucket.
+        /// @param now The current Moment.
+        /// @return The number of whole tokens available.
+        unsigned long long available(const MomentType &now) const
+        {
+            long long elapsed = gcra_.elapsed(now);
+            return gcra_.tokensIn(gcra_.limit() - (gcra_.earliest(elapsed) - elapsed));
+        }
+
+        /// @brief Returns the maximum number of tokens in the bucket.
+        /// @return The burst size.
+        unsigned long long burst() const
+        {
+            return gcra_.burst();
+        }
+    };
+
+    /// @brief A leaky bucket rate limiter used as a queue: requests are admitted while the backlog is short enough, and each
+    ///        is given the delay after which it may proceed, so that admitted requests leave at an even rate without bursts.
+    /// @details Implemented with the generic cell rate algorithm, so the whole state is one timestamp. `tryAcquire` is a
+    ///          lock-free compare-and-swap loop on that timestamp, and one instance can be shared by many threads.
+    /// @tparam MomentType The Moment type read by the overloads without a `now` argument.
+    template <typename MomentType = Moment>
+    class LeakyBucket
+    {
+    public:
+        /// The Duration type matching `MomentType`.
+        typedef typename detail::Gcra<MomentType>::DurationType DurationType;
+
+    private:
+        detail::Gcra<MomentType> gcra_;
+
+    public:
+        /// @brief Constructs an empty LeakyBucket.
+        /// @param tokens The number of tokens that leave the bucket every `period`. Zero is treated as one.
+        /// @param period The time in which `tokens` tokens leave. The time per token is kept to 1/65536 of a nanosecond,
+        ///        and the time for each acquisition is rounded up to a whole nanosecond.
+        /// @param capacity The maximum number of tokens waiting in the bucket. Requests that would exceed it are rejected.
+        /// @param start The Moment to measure time from.
+        LeakyBucket(unsigned long long tokens, const DurationType &period, unsigned long long capacity, const MomentType &start = MomentType::now())
+            : gcra_(tokens, period, capacity, start)
+        {
+        }
+
+        LeakyBucket(const LeakyBucket &) = delete;
+        LeakyBucket &operator=(const LeakyBucket &) = delete;
+
+        /// @brief Adds tokens to the bucket if they fit.
+        /// @param count The number of tokens to add.
+        /// @param now The current Moment.
+        /// @return An Option containing how long the caller must wait before proceeding, rounded up to a whole tick, or an
+        ///         empty Option if the bucket is too full. Nothing is added on failure.
+        Option<DurationType> tryAcquire(unsigned long long count, const MomentType &now)
+        {
+            long long elapsed = gcra_.elapsed(now);
+            long long start;
+            if (!gcra_.reserve(elapsed, gcra_.cost(count), gcra_.limit(), start))
+            {
+                return Option<DurationType>();
+            }
+            return Option<DurationType>(detail::Gcra<MomentType>::toDuration(start - elapsed));
+        }
+
+        /// @brief Adds tokens to the bucket if they fit, reading the current time from `MomentType::now()`.
+        /// @param count The number of tokens to add.
+        /// @return An Option containing how long the caller must wait before proceeding, or an empty Option if the bucket is too full.
+        Option<DurationType> tryAcquire(unsigned long long count = 1)
+        {
+            return tryAcquire(count, MomentType::now());
+        }
+
+        /// @brief Returns how long until enough room is available.
+        /// @param count The number of tokens to add.
+        /// @param now The current Moment.
+        /// @return The time until `tryAcquire(count)` can succeed, or zero if it can now. Rounded up to a whole tick.
+        /// @note Another thread may take the room first.
+        DurationType timeUntilAvailable(unsigned long long count, const MomentType &now) const
+        {
+            long long elapsed = gcra_.elapsed(now);
+            return detail::Gcra<MomentType>::toDuration(gcra_.earliest(elapsed) + gcra_.cost(count) - gcra_.limit() - elapsed);
+        }
+
+        /// @brief Returns how long until enough room is available, reading the current time from `MomentType::now()`.
+        /// @param count The number of tokens to add.
+        /// @return The time until `tryAcquire(count)` can succeed, or zero if it can now.
+        DurationType timeUntilAvailable(unsigned long long count = 1) const
+        {
+            return timeUntilAvailable(count, MomentType::now());
+        }
+
+        /// @brief Returns how long the tokens already in the bucket take to leave.
+        /// @param now The current Moment.
+        /// @return The current backlog, rounded up to a whole tick.
+        DurationType backlog(const MomentType &now) const
+        {
+            long long elapsed = gcra_.elapsed(now);
+            return detail::Gcra<MomentType>::toDuration(gcra_.earliest(elapsed) - elapsed);
+        }
+    };
+}
+
+#endif // FENZ_RATE_LIMIT_HPP
@@ -0,0 +1,332 @@
+#include "array.hpp"
+#include "functional.hpp"
+#include "option.hpp"
+#include "scheduler.hpp"
+
+#ifndef FENZ_SCAN_HPP
+#define FENZ_SCAN_HPP
+
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace fenz
+{
+    namespace detail
+    {
+        enum
+        {
+            /// Arrays up to this size are scanned on the calling thread by the parallel scans.
+            ParallelScanMinSize = 1 << 16,
+            /// The most blocks a parallel scan splits an array into.
+            MaxScanBlocks = 64
+        };
+
+        /// @brief Scans elements one at a time. `input` and `output` may be the same.
+        template <typename T, typename Op>
+        struct SequentialScan
+        {
+            /// @return The accumulated value after the last element.
+            static T inclusive(const T *input, T *output, int count, T seed, Op &op)
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    seed = op(seed, input[i]);
+                    output[i] = seed;
+                }
+                return seed;
+            }
+
+            /// @return The accumulated value after the last element.
+            static T exclusive(const T *input, T *output, int count, T seed, Op &op)
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    T value = input[i];
+                    output[i] = seed;
+                    seed = op(seed, value);
+                }
+                return seed;
+            }
+        };
+
+        /// @brief The fastest scan for an element type and operator. Vectorized for sums of 32-bit integers and floats.
+        template <typename T, typename Op>
+        struct ScanKernel : SequentialScan<T, Op>
+        {
+        };
+
+#if defined(__SSE2__)
+        /// @brief Sums of 32-bit integers, four at a time.
+        /// @details Each vector is scanned in its register with two shifted adds, and then the running total is added to
+        ///          all four lanes, so the loop-carried dependency is one add and one shuffle per four elements.
+        template <typename T>
+        struct IntegerScanKernel
+        {
+            static __m128i scanVector(__m128i x)
+            {
+                x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+                return _mm_add_epi32(x, _mm_slli_si128(x, 8));
+            }
+
+            static T inclusive(const T *input, T *output, int count, T seed, Plus<T> &op)
+            {
+                __m128i carry = _mm_set1_epi32(static_cast<int>(seed));
+                int i = 0;
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m128i x = scanVector(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i)));
+                    x = _mm_add_epi32(x, carry);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), x);
+                    carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+                }
+                T total = static_cast<T>(_mm_cvtsi128_si32(carry));
+                return SequentialScan<T, Plus<T>>::inclusive(input + i, output + i, count - i, total, op);
+            }
+
+            static T exclusive(const T *input, T *output, int count, T seed, Plus<T> &op)
+            {
+                __m128i carry = _mm_set1_epi32(static_cast<int>(seed));
+                int i = 0;
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m128i x = scanVector(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i)));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_add_epi32(_mm_slli_si128(x, 4), carry));
+                    carry = _mm_add_epi32(carry, _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3)));
+                }
+                T total = static_cast<T>(_mm_cvtsi128_si32(carry));
+                return SequentialScan<T, Plus<T>>::exclusive(input + i, output + i, count - i, total, op);
+            }
+        };
+
+        template <>
+        struct ScanKernel<int, Plus<int>> : IntegerScanKernel<int>
+        {
+        };
+
+        template <>
+        struct ScanKernel<unsigned int, Plus<unsigned int>> : IntegerScanKernel<unsigned int>
+        {
+        };
+
+        /// @brief Sums of floats, four at a time, as for integers.
+        /// @details The additions are grouped differently than in a sequential loop, so sums can differ in the last bits.
+        template <>
+        struct ScanKernel<float, Plus<float>>
+        {
+            static __m128 scanVector(__m128 x)
+            {
+                x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+                return _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+            }
+
+            static float inclusive(const float *input, float *output, int count, float seed, Plus<float> &op)
+            {
+                __m128 carry = _mm_set1_ps(seed);
+                int i = 0;
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m128 x = _mm_add_ps(scanVector(_mm_loadu_ps(input + i)), carry);
+                    _mm_storeu_ps(output + i, x);
+                    carry = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+                }
+                return SequentialScan<float, Plus<float>>::inclusive(input + i, output + i, count - i, _mm_cvtss_f32(carry), op);
+            }
+
+            static float exclusive(const float *input, float *output, int count, float seed, Plus<float> &op)
+            {
+                __m128 carry = _mm_set1_ps(seed);
+                int i = 0;
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m128 x = scanVector(_mm_loadu_ps(input + i));
+                    __m128 shifted = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4));
+                    _mm_storeu_ps(output + i, _mm_add_ps(shifted, carry));
+                    carry = _mm_add_ps(carry, _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3)));
+                }
+                return SequentialScan<float, Plus<float>>::exclusive(input + i, output + i, count - i, _mm_cvtss_f32(carry), op);
+            }
+        };
+#endif
+
+        /// @brief Inclusive scan starting from the first element.
+        /// @return The total of all elements.
+        template <typename T, typename Op>
+        inline T inclusiveScan(const T *input, T *output, int count, Op &op)
+        {
+            T first = input[0];
+            output[0] = first;
+            return ScanKernel<T, Op>::inclusive(input + 1, output + 1, count - 1, first, op);
+        }
+
+        /// @brief Two-pass block scan: the blocks are reduced in parallel, their totals are scanned on the calling
+        ///        thread, and then the blocks are scanned in parallel, each starting from the total of the ones before it.
+        /// @param seed The value to start from. Required for exclusive scans. Without one, an inclusive scan starts from
+        ///        the first element.
+        /// @return The total of all elements, including the seed.
+        template <unsigned int Workers, unsigned int Capacity, typename T, typename Op>
+        T parallelScan(Scheduler<Workers, Capacity> &scheduler, const T *input, T *output, int count,
+                       const Option<T> &seed, bool inclusive, Op &op)
+        {
+            const int blocks = 4 * (Workers + 1) < MaxScanBlocks ? static_cast<int>(4 * (Workers + 1)) : MaxScanBlocks;
+            const int blockSize = (count + blocks - 1) / blocks;
+
+            // Only the blocks before the last one need totals, and they are all full
+            T totals[MaxScanBlocks];
+            scheduler.parallelFor(0, blocks - 1, [&](int block)
+                                  {
+                                      const T *first = input + block * blockSize;
+                                      T total = first[0];
+                                      for (int i = 1; i < blockSize; ++i)
+                                      {
+                                          total = op(total, first[i]);
+                                      }
+                                      totals[block] = total; });
+
+            T starts[MaxScanBlocks];
+            if (seed.hasValue())
+            {
+                starts[0] = seed.value_unsafely();
+            }
+            for (int block = 1; block < blocks; ++block)
+            {
+                starts[block] = block == 1 && !seed.hasValue() ? totals[0] : op(starts[block - 1], totals[block - 1]);
+            }
+
+            // The last block is never empty, since arrays this large have more elements than blocks squared
+            T total = T();
+            scheduler.parallelFor(0, blocks, [&](int block)
+                                  {
+                                      int begin = block * blockSize;
+                                      int end = begin + blockSize < count ? begin + blockSize : count;
+                                      T blockTotal;
+                                      if (block == 0 && !seed.hasValue())
+                                      {
+                                          blockTotal = inclusiveScan(input, output, end, op);
+                                      }
+                                      else if (inclusive)
+                                      {
+                                          blockTotal = ScanKernel<T, Op>::inclusive(input + begin, output + begin, end - begin, starts[block], op);
+                                      }
+                                      else
+                                      {
+                                          blockTotal = ScanKernel<T, Op>::exclusive(input + begin, output + begin, end - begin, starts[block], op);
+                                      }
+                                      if (block == blocks - 1)
+                                      {
+                                          total = blockTotal;
+                                      } });
+            return total;
+        }
+    }
+
+    /// @brief Computes the running totals of an Iterable: `output[i]` is `input[0] op input[1] op ... op input[i]`.
+    /// @details Sums of `int`, `unsigned int` and `float` are computed four elements at a time with SSE2. Float sums
+    ///          are then grouped differently than in a sequential loop, so they can differ in the last bits.
+    /// @tparam Op An associative operator taking `(const T&, const T&)` and returning `T`, e.g. `Plus<T>`, `Min<T>` or `Max<T>`.
+    /// @param input The elements to scan. May be a read-only view, e.g. `Iterable<const T, N>`.
+    /// @param output Where to write the running totals. May be the same as `input`.
+    /// @param op The operator, `Plus<T>` by default.
+    template <typename U, typename T, int N, typename Op = Plus<T>>
+    inline void inclusiveScan(const Iterable<U, N> &input, Iterable<T, N> &output, Op op = Op())
+    {
+        static_assert(std::is_same<typename std::remove_cv<U>::type, T>::value, "Scans must read and write the same element type");
+        detail::inclusiveScan(input.begin(), output.begin(), N, op);
+    }
+
+    /// @brief Computes the running totals of an Iterable before each element: `output[0]` is `initial`, and
+    ///        `output[i]` is `initial op input[0] op ... op input[i - 1]`, e.g. the offsets of variable-sized items.
+    /// @details Vectorized for the same types as `inclusiveScan`.
+    /// @tparam Op An associative operator taking `(const T&, const T&)` and returning `T`.
+    /// @param input The elements to scan. May be a read-only view, e.g. `Iterable<const T, N>`.
+    /// @param output Where to write the running totals. May be the same as `input`.
+    /// @param initial The value to start from, usually the identity of `op`.
+    /// @param op The operator, `Plus<T>` by default.
+    /// @return The total of all elements, starting from `initial`.
+    template <typename U, typename T, int N, typename Op = Plus<T>>
+    inline T exclusiveScan(const Iterable<U, N> &input, Iterable<T, N> &output,
+                           const typename detail::NonDeduced<T>::type &initial, Op op = Op())
+    {
+        static_assert(std::is_same<typename std::remove_cv<U>::type, T>::value, "Scans must read and write the same element type");
+        return detail::ScanKernel<T, Op>::exclusive(input.begin(), output.begin(), N, initial, op);
+    }
+
+    /// @brief Replaces each element of an Iterable with the running total up to and including it.
+    /// @tparam Op An associative operator taking `(const T&, const T&)` and returning `T`.
+    /// @param items The elements to scan.
+    /// @param op The operator, `Plus<T>` by default.
+    template <typename T, int N, typename Op = Plus<T>>
+    inline void scanInPlace(Iterable<T, N> &items, Op op = Op())
+    {
+        detail::inclusiveScan(items.begin(), items.begin(), N, op);
+    }
+
+    /// @brief Computes the running totals of an Iterable as `inclusiveScan(input, output, op)`, using the workers of a Scheduler.
+    /// @details Arrays of up to 65536 elements are scanned on the calling thread. Larger ones are split into blocks,
+    ///          which are first reduced and then scanned in parallel, so each element is read twice and written once.
+    /// @tparam T The type of elements. Must be default constructible.
+    /// @tparam Op An associative operator taking `(const T&, const T&)` and returning `T`. It is called from several
+    ///         threads at once.
+    /// @param input The elements to scan. May be a read-only view, e.g. `Iterable<const T, N>`.
+    /// @param output Where to write the running totals. May be the same as `input`.
+    /// @param scheduler The Scheduler whose workers help with the scan.
+    /// @param op The operator, `Plus<T>` by default.
+    template <typename U, typename T, int N, unsigned int Workers, unsigned int Capacity, typename Op = Plus<T>>
+    inline void inclusiveScan(const Iterable<U, N> &input, Iterable<T, N> &output, Scheduler<Workers, Capacity> &scheduler,
+                              Op op = Op())
+    {
+        static_assert(std::is_same<typename std::remove_cv<U>::type, T>::value, "Scans must read and write the same element type");
+        if (N <= detail::ParallelScanMinSize)
+        {
+            inclusiveScan(input, output, op);
+        }
+        else
+        {
+            detail::parallelScan(scheduler, input.begin(), output.begin(), N, Option<T>(), true, op);
+        }
+    }
+
+    /// @brief Computes the running totals of an Iterable before each element as `exclusiveScan(input, output, initial, op)`,
+    ///        using the workers of a Scheduler.
+    /// @details Parallel for the same sizes as `inclusiveScan`.
+    /// @tparam T The type of elements. Must be default constructible.
+    /// @tparam Op An associative operator taking `(const T&, const T&)` and returning `T`. It is called from several
+    ///         threads at once.
+    /// @param input The elements to scan. May be a read-only view, e.g. `Iterable<const T, N>`.
+    /// @param output Where to write the running totals. May be the same as `input`.
+    /// @param initial The value to start from, usually the identity of `op`.
+    /// @param scheduler The Scheduler whose workers help with the scan.
+    /// @param op The operator, `Plus<T>` by default.
+    /// @return The total of all elements, starting from `initial`.
+    template <typename U, typename T, int N, unsigned int Workers, unsigned int Capacity, typename Op = Plus<T>>
+    inline T exclusiveScan(const Iterable<U, N> &input, Iterable<T, N> &output,
+                           const typename detail::NonDeduced<T>::type &initial, Scheduler<Workers, Capacity> &scheduler,
+                           Op op = Op())
+    {
+        static_assert(std::is_same<typename std::remove_cv<U>::type, T>::value, "Scans must read and write the same element type");
+        if (N <= detail::ParallelScanMinSize)
+        {
+            return exclusiveScan(input, output, initial, op);
+        }
+        return detail::parallelScan(scheduler, input.begin(), output.begin(), N, Option<T>(initial), false, op);
+    }
+
+    /// @brief Replaces each element of an Iterable with the running total up to and including it, using the workers
+    ///        of a Scheduler.
+    /// @details Parallel for the same sizes as `inclusiveScan`.
+    /// @tparam T The type of elements. Must be default constructible.
+    /// @tparam Op An associative operator taking `(const T&, const T&)` and returning `T`. It is called from several
+    ///         threads at once.
+    /// @param items The elements to scan.
+    /// @param scheduler The Scheduler whose workers help with the scan.
+    /// @param op The operator, `Plus<T>` by default.
+    template <typename T, int N, unsigned int Workers, unsigned int Capacity, typename Op = Plus<T>>
+    inline void scanInPlace(Iterable<T, N> &items, Scheduler<Workers, Capacity> &scheduler, Op op = Op())
+    {
+        inclusiveScan(items, items, scheduler, op);
+    }
+}
+
+#endif // FENZ_SCAN_HPP
@@ -0,0 +1,548 @@
+#include "option.hpp"
+#include "queue.hpp"
+
+#ifndef FENZ_SCHEDULER_HPP
+#define FENZ_SCHEDULER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace fenz
+{
+    /// @brief A fixed-capacity Chase-Lev work-stealing deque.
+    /// @details The owning thread pushes and pops at the bottom, while any other thread may steal from the top.
+    ///          No operation takes a lock.
+    /// @tparam T The type of elements in the deque. Must be trivially copyable, typically a pointer.
+    /// @tparam Capacity The maximum number of elements the deque can hold. Must be a power of two.
+    template <typename T, unsigned int Capacity>
+    class WorkStealingDeque
+    {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "WorkStealingDeque capacity must be a power of two");
+        static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque elements must be trivially copyable");
+
+    private:
+        alignas(64) std::atomic<long long> top_;
+        alignas(64) std::atomic<long long> bottom_;
+        alignas(64) std::atomic<T> buffer_[Capacity];
+
+    public:
+        /// @brief Constructs an empty WorkStealingDeque.
+        WorkStealingDeque() : top_(0), bottom_(0) {}
+
+        WorkStealingDeque(const WorkStealingDeque &) = delete;
+        WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+        /// @brief Adds an item to the bottom of the deque.
+        /// @return True if the item was added, false if the deque is full.
+        /// @param item The item to add.
+        /// @warning Must only be called by the owning thread.
+        bool push(const T &item)
+        {
+            long long b = bottom_.load(std::memory_order_relaxed);
+            long long t = top_.load(std::memory_order_acquire);
+            if (b - t >= static_cast<long long>(Capacity))
+            {
+                return false;
+            }
+            buffer_[b & (Capacity - 1)].store(item, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// @brief Removes and returns the item at the bottom of the deque, which is the most recently pushed one.
+        /// @return An Option containing the item, or an empty Option if the deque is empty.
+        /// @warning Must only be called by the owning thread.
+        Option<T> pop()
+        {
+            long long b = bottom_.load(std::memory_order_relaxed) - 1;
+            bottom_.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            long long t = top_.load(std::memory_order_relaxed);
+
+            if (t > b)
+            {
+                bottom_.store(b + 1, std::memory_order_relaxed);
+                return Option<T>();
+            }
+
+            T item = buffer_[b & (Capacity - 1)].load(std::memory_order_relaxed);
+            if (t == b)
+            {
+                // Last item, race against thieves for it
+                bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom_.store(b + 1, std::memory_order_relaxed);
+                if (!won)
+                {
+                    return Option<T>();
+                }
+            }
+            return Option<T>(item);
+        }
+
+        /// @brief Removes and returns the item at the top of the deque, which is the least recently pushed one.
+        /// @return An Option containing the item, or an empty Option if the deque is empty or another thread won the race for the item.
+        /// @note May be called from any thread.
+        Option<T> steal()
+        {
+            long long t = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            long long b = bottom_.load(std::memory_order_acquire);
+            if (t >= b)
+            {
+                return Option<T>();
+            }
+
+            T item = buffer_[t & (Capacity - 1)].load(std::memory_order_relaxed);
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return Option<T>();
+            }
+            return Option<T>(item);
+        }
+
+        /// @brief Returns the number of elements in the deque.
+        /// @return The number of elements in the deque.
+        /// @note The result is only a snapshot when other threads are using the deque.
+        unsigned int size() const
+        {
+            long long b = bottom_.load(std::memory_order_relaxed);
+            long long t = top_.load(std::memory_order_relaxed);
+            return b > t ? static_cast<unsigned int>(b - t) : 0;
+        }
+
+        /// @brief Returns the maximum capacity of the deque.
+        /// @return The maximum capacity of the deque.
+        constexpr unsigned int capacity() const
+        {
+            return Capacity;
+        }
+
+        /// @brief Checks if the deque is empty.
+        /// @return True if the deque is empty, false otherwise.
+        /// @note The result is only a snapshot when other threads are using the deque.
+        bool isEmpty() const
+        {
+            return size() == 0;
+        }
+    };
+
+    template <unsigned int Workers, unsigned int Capacity>
+    class Scheduler;
+
+    /// @brief The type-independent part of a Task, which is what a Scheduler runs.
+    class TaskBase
+    {
+        template <unsigned int, unsigned int>
+        friend class Scheduler;
+
+    protected:
+        enum State
+        {
+            Idle,
+            Queued,
+            Done
+        };
+
+        /// The function that runs the task and stores its result.
+        void (*run_)(TaskBase *);
+        std::atomic<int> state_;
+
+        TaskBase(void (*run)(TaskBase *)) : run_(run), state_(Idle) {}
+        ~TaskBase() = default;
+
+        /// @brief Runs the task and marks it as done.
+        void execute()
+        {
+            run_(this);
+            state_.store(Done, std::memory_order_release);
+        }
+
+    public:
+        TaskBase &operator=(const TaskBase &) = delete;
+
+        /// @brief Checks if the task has finished running.
+        /// @return True if the task has finished running.
+        bool isDone() const
+        {
+            return state_.load(std::memory_order_acquire) == Done;
+        }
+
+        /// @brief Blocks until the task has finished running.
+        /// @note Returns immediately if the task was never spawned.
+        ///       Use `Scheduler::wait` instead when calling from a worker thread, so that the worker keeps running tasks while waiting.
+        void wait() const
+        {
+            while (state_.load(std::memory_order_acquire) == Queued)
+            {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    namespace detail
+    {
+        /// @brief Maps the return type of a task function to the type of its result. Functions returning void produce `true`.
+        template <typename R>
+        struct TaskResult
+        {
+            typedef R type;
+
+            template <typename Func>
+            static R invoke(Func &func)
+            {
+                return func();
+            }
+        };
+
+        template <>
+        struct TaskResult<void>
+        {
+            typedef bool type;
+
+            template <typename Func>
+            static bool invoke(Func &func)
+            {
+                func();
+                return true;
+            }
+        };
+    }
+
+    /// @brief A unit of work that can be spawned on a Scheduler, holding the function to run and its result.
+    /// @details Tasks do not allocate; the caller owns the Task and must keep it alive until it is done.
+    ///          Destroying a Task waits for it to finish running.
+    /// @tparam Func A callable taking no arguments. If it returns void, the result of the task is `true`.
+    template <typename Func>
+    class Task : public TaskBase
+    {
+    public:
+        /// The type of the task's result.
+        typedef typename detail::TaskResult<decltype(std::declval<Func &>()())>::type Result;
+
+    private:
+        Func func_;
+        Option<Result> result_;
+
+        static void invoke(TaskBase *base)
+        {
+            Task *self = static_cast<Task *>(base);
+            self->result_ = Option<Result>(detail::TaskResult<decltype(std::declval<Func &>()())>::invoke(self->func_));
+        }
+
+    public:
+        /// @brief Constructs a Task that runs a function.
+        /// @param func The function to run.
+        Task(Func func) : TaskBase(&Task::invoke), func_(func) {}
+
+        /// @brief Copy constructor. The copy holds the same function, but has not been spawned and has no result.
+        /// @param other The Task to copy the function from.
+        Task(const Task &other) : TaskBase(&Task::invoke), func_(other.func_) {}
+
+        /// @brief Destructor. Waits for the task to finish running if it has been spawned.
+        ~Task()
+        {
+            wait();
+        }
+
+        /// @brief Returns the result of the task.
+        /// @return An Option containing the result if the task is done, or an empty Option otherwise.
+        Option<Result> result() const
+        {
+            if (!isDone())
+            {
+                return Option<Result>();
+            }
+            return result_;
+        }
+    };
+
+    /// @brief Creates a Task that runs a function.
+    /// @param func The function to run.
+    /// @return A Task holding the function.
+    template <typename Func>
+    inline Task<Func> makeTask(Func func)
+    {
+        return Task<Func>(func);
+    }
+
+    /// @brief A fixed pool of worker threads that run Tasks.
+    /// @details Each worker owns a WorkStealingDeque. Tasks spawned from a worker go to its own deque, tasks spawned
+    ///          from other threads go to a shared queue, and idle workers steal from each other before parking.
+    ///          Parked workers use no CPU and are only woken when there is work to do.
+    /// @tparam Workers The number of worker threads.
+    /// @tparam Capacity The maximum number of queued tasks per worker, and in the shared queue. Must be a power of two.
+    template <unsigned int Workers, unsigned int Capacity = 1024>
+    class Scheduler
+    {
+        static_assert(Workers > 0, "Scheduler must have at least one worker");
+
+    private:
+        struct alignas(64) Worker
+        {
+            WorkStealingDeque<TaskBase *, Capacity> deque;
+            std::thread thread;
+        };
+
+        /// @brief Identifies the worker that the current thread is, if any.
+        struct Context
+        {
+            Scheduler *scheduler;
+            unsigned int index;
+        };
+
+        Worker workers_[Workers];
+
+        std::mutex injectedMutex_;
+        Queue<TaskBase *, Capacity> injected_;
+        std::atomic<unsigned int> injectedCount_;
+
+        std::mutex parkMutex_;
+        std::condition_variable parked_;
+        std::atomic<unsigned int> sleepers_;
+        std::atomic<bool> stopping_;
+
+        static Context &context()
+        {
+            static thread_local Context current = {nullptr, 0};
+            return current;
+        }
+
+        /// @brief Returns the index of the worker that the current thread is, or `Workers` if it is not one of this scheduler's workers.
+        unsigned int currentWorker() const
+        {
+            const Context &current = context();
+            return current.scheduler == this ? current.index : Workers;
+        }
+
+        Option<TaskBase *> takeInjected()
+        {
+            if (injectedCount_.load(std::memory_order_acquire) == 0)
+            {
+                return Option<TaskBase *>();
+            }
+            std::lock_guard<std::mutex> lock(injectedMutex_);
+            Option<TaskBase *> task = injected_.dequeue();
+            if (task)
+            {
+                injectedCount_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            return task;
+        }
+
+        /// @brief Finds a task to run: first from the own deque, then from the shared queue, then by stealing.
+        /// @param self Index of the calling worker, or `Workers` if the caller is not a worker.
+        Option<TaskBase *> findTask(unsigned int self)
+        {
+            if (self < Workers)
+            {
+                Option<TaskBase *> task = workers_[self].deque.pop();
+                if (task)
+                {
+                    return task;
+                }
+            }
+
+            Option<TaskBase *> task = takeInjected();
+            if (task)
+            {
+                return task;
+            }
+
+            unsigned int start = self < Workers ? self + 1 : 0;
+            for (unsigned int i = 0; i < Workers; ++i)
+            {
+                unsigned int victim = (start + i) % Workers;
+                if (victim == self)
+                {
+                    continue;
+                }
+                task = workers_[victim].deque.steal();
+                if (task)
+                {
+                    return task;
+                }
+            }
+            return Option<TaskBase *>();
+        }
+
+        bool hasWork() const
+        {
+            if (injectedCount_.load(std::memory_order_acquire) != 0)
+            {
+                return true;
+            }
+            for (unsigned int i = 0; i < Workers; ++i)
+            {
+                if (!workers_[i].deque.isEmpty())
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void wakeOne()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleepers_.load(std::memory_order_relaxed) > 0)
+            {
+                std::lock_guard<std::mutex> lock(parkMutex_);
+                parked_.notify_one();
+            }
+        }
+
+        void workerLoop(unsigned int index)
+        {
+            context() = {this, index};
+
+            while (true)
+            {
+                Option<TaskBase *> task = findTask(index);
+                if (task)
+                {
+                    task.value_unsafely()->execute();
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(parkMutex_);
+                sleepers_.fetch_add(1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                bool stop = stopping_.load(std::memory_order_acquire);
+                bool work = hasWork();
+                if (!work && !stop)
+                {
+                    parked_.wait(lock);
+                }
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                if (!work && stop)
+                {
+                    break;
+                }
+            }
+
+            context() = {nullptr, 0};
+        }
+
+    public:
+        /// @brief Constructs a Scheduler and starts its worker threads.
+        Scheduler() : injectedCount_(0), sleepers_(0), stopping_(false)
+        {
+            for (unsigned int i = 0; i < Workers; ++i)
+            {
+                workers_[i].thread = std::thread(&Scheduler::workerLoop, this, i);
+            }
+        }
+
+        /// @brief Destructor. Runs all remaining tasks, then stops and joins the worker threads.
+        ~Scheduler()
+        {
+            {
+                std::lock_guard<std::mutex> lock(parkMutex_);
+                stopping_.store(true, std::memory_order_release);
+                parked_.notify_all();
+            }
+            for (unsigned int i = 0; i < Workers; ++i)
+            {
+                workers_[i].thread.join();
+            }
+        }
+
+        Scheduler(const Scheduler &) = delete;
+        Scheduler &operator=(const Scheduler &) = delete;
+
+        /// @brief Queues a task to be run by one of the workers.
+        /// @param task The task to run. Must stay alive until it is done.
+        /// @return True if the task was queued, false if the queues are full or the task is already queued.
+        bool spawn(TaskBase &task)
+        {
+            int expected = TaskBase::Idle;
+            if (!task.state_.compare_exchange_strong(expected, TaskBase::Queued, std::memory_order_relaxed))
+            {
+                expected = TaskBase::Done;
+                if (!task.state_.compare_exchange_strong(expected, TaskBase::Queued, std::memory_order_relaxed))
+                {
+                    return false;
+                }
+            }
+
+            unsigned int self = currentWorker();
+            bool queued = self < Workers && workers_[self].deque.push(&task);
+            if (!queued)
+            {
+                std::lock_guard<std::mutex> lock(injectedMutex_);
+                queued = injected_.enqueue(&task);
+                if (queued)
+                {
+                    injectedCount_.fetch_add(1, std::memory_order_release);
+                }
+            }
+
+            if (!queued)
+            {
+                task.state_.store(TaskBase::Idle, std::memory_order_relaxed);
+                return false;
+            }
+            wakeOne();
+            return true;
+        }
+
+        /// @brief Blocks until a task has finished running, running other queued tasks in the meantime.
+        /// @param task The task to wait for.
+        void wait(const TaskBase &task)
+        {
+            unsigned int self = currentWorker();
+            while (task.state_.load(std::memory_order_acquire) == TaskBase::Queued)
+            {
+                Option<TaskBase *> other = findTask(self);
+                if (other)
+                {
+                    other.value_unsafely()->execute();
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        /// @brief Calls a function for each index in a range, spreading the calls over the workers.
+        /// @details The range is split in halves recursively; one half is spawned and the other is run by the calling thread.
+        ///          The calling thread takes part in the work, and the call returns once all indices are done.
+        /// @param begin The first index.
+        /// @param end One past the last index.
+        /// @param func A callable taking `(int)` — the index.
+        template <typename Func>
+        void parallelFor(int begin, int end, const Func &func)
+        {
+            while (end - begin > 1)
+            {
+                int middle = begin + (end - begin) / 2;
+                auto rest = makeTask([this, middle, end, &func]() { parallelFor(middle, end, func); });
+                if (!spawn(rest))
+                {
+                    rest.execute();
+                }
+                parallelFor(begin, middle, func);
+                wait(rest);
+                return;
+            }
+            if (begin < end)
+            {
+                func(begin);
+            }
+        }
+
+        /// @brief Returns the number of worker threads.
+        /// @return The number of worker threads.
+        constexpr unsigned int workerCount() const
+        {
+            return Workers;
+        }
+    };
+}
+
+#endif // FENZ_SCHEDULER_HPP
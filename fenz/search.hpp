@@ -0,0 +1,521 @@
+#include "array.hpp"
+#include "bitarray.hpp"
+#include "functional.hpp"
+#include "option.hpp"
+
+#ifndef FENZ_SEARCH_HPP
+#define FENZ_SEARCH_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace fenz
+{
+    namespace detail
+    {
+        enum
+        {
+            /// Sorted arrays of vectorizable integers up to this many bytes are searched by counting smaller elements.
+            LinearLowerBoundMaxBytes = 256,
+            /// Binary searches over arrays larger than this many bytes prefetch the next midpoints.
+            PrefetchSearchMinBytes = 16384
+        };
+
+        /// @brief Searches elements one at a time.
+        template <typename T>
+        struct LinearSearch
+        {
+            /// @return The index of the first element equal to `value`, or -1.
+            static int find(const T *items, int count, const T &value)
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    if (items[i] == value)
+                    {
+                        return i;
+                    }
+                }
+                return -1;
+            }
+
+            static int count(const T *items, int count, const T &value)
+            {
+                int matches = 0;
+                for (int i = 0; i < count; ++i)
+                {
+                    matches += items[i] == value ? 1 : 0;
+                }
+                return matches;
+            }
+        };
+
+        /// @brief True for integers that can be compared 32 bytes at a time.
+        template <typename T>
+        struct IsVectorSearchable
+        {
+            static constexpr bool value = std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                          (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+        };
+
+        /// @brief The fastest linear search for an element type. Uses AVX2 for integers.
+        template <typename T, bool Vector = IsVectorSearchable<T>::value>
+        struct SearchKernel : LinearSearch<T>
+        {
+        };
+
+#if defined(__AVX2__)
+        template <int Size>
+        struct VectorLanes;
+
+        template <>
+        struct VectorLanes<1>
+        {
+            static __m256i broadcast(long long value) { return _mm256_set1_epi8(static_cast<char>(value)); }
+            static __m256i equal(__m256i a, __m256i b) { return _mm256_cmpeq_epi8(a, b); }
+            static __m256i greater(__m256i a, __m256i b) { return _mm256_cmpgt_epi8(a, b); }
+        };
+
+        template <>
+        struct VectorLanes<2>
+        {
+            static __m256i broadcast(long long value) { return _mm256_set1_epi16(static_cast<short>(value)); }
+            static __m256i equal(__m256i a, __m256i b) { return _mm256_cmpeq_epi16(a, b); }
+            static __m256i greater(__m256i a, __m256i b) { return _mm256_cmpgt_epi16(a, b); }
+        };
+
+        template <>
+        struct VectorLanes<4>
+        {
+            static __m256i broadcast(long long value) { return _mm256_set1_epi32(static_cast<int>(value)); }
+            static __m256i equal(__m256i a, __m256i b) { return _mm256_cmpeq_epi32(a, b); }
+            static __m256i greater(__m256i a, __m256i b) { return _mm256_cmpgt_epi32(a, b); }
+        };
+
+        template <>
+        struct VectorLanes<8>
+        {
+            static __m256i broadcast(long long value) { return _mm256_set1_epi64x(value); }
+            static __m256i equal(__m256i a, __m256i b) { return _mm256_cmpeq_epi64(a, b); }
+            static __m256i greater(__m256i a, __m256i b) { return _mm256_cmpgt_epi64(a, b); }
+        };
+
+        /// @brief Compares 32 bytes of elements at a time and turns the result into a bit mask with `movemask`.
+        /// @details The mask has one bit per byte, so each matching element sets `sizeof(T)` bits.
+        template <typename T>
+        struct SearchKernel<T, true>
+        {
+            typedef VectorLanes<sizeof(T)> Lanes;
+            static constexpr int Width = 32 / sizeof(T);
+
+            static __m256i load(const T *items)
+            {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(items));
+            }
+
+            static unsigned int mask(__m256i comparison)
+            {
+                return static_cast<unsigned int>(_mm256_movemask_epi8(comparison));
+            }
+
+            /// @brief Flips the sign bit of unsigned elements, so that the signed comparison orders them correctly.
+            static __m256i orderable(__m256i x)
+            {
+                return std::is_signed<T>::value ? x : _mm256_xor_si256(x, Lanes::broadcast(1LL << (8 * sizeof(T) - 1)));
+            }
+
+            static int find(const T *items, int count, const T &value)
+            {
+                __m256i needle = Lanes::broadcast(static_cast<long long>(value));
+                int i = 0;
+                for (; i + Width <= count; i += Width)
+                {
+                    unsigned int matches = mask(Lanes::equal(load(items + i), needle));
+                    if (matches != 0)
+                    {
+                        return i + countTrailingZeros64(matches) / static_cast<int>(sizeof(T));
+                    }
+                }
+                int rest = LinearSearch<T>::find(items + i, count - i, value);
+                return rest < 0 ? -1 : i + rest;
+            }
+
+            static int count(const T *items, int count, const T &value)
+            {
+                __m256i needle = Lanes::broadcast(static_cast<long long>(value));
+                int bits = 0;
+                int i = 0;
+                for (; i + Width <= count; i += Width)
+                {
+                    bits += popcount64(mask(Lanes::equal(load(items + i), needle)));
+                }
+                return bits / static_cast<int>(sizeof(T)) + LinearSearch<T>::count(items + i, count - i, value);
+            }
+
+            /// @return The number of elements less than `value`, or with `orEqual`, not greater than it.
+            static int countLess(const T *items, int count, const T &value, bool orEqual)
+            {
+                __m256i needle = orderable(Lanes::broadcast(static_cast<long long>(value)));
+                int bits = 0;
+                int i = 0;
+                for (; i + Width <= count; i += Width)
+                {
+                    __m256i x = orderable(load(items + i));
+                    // x <= value is the complement of x > value
+                    bits += orEqual ? Width * static_cast<int>(sizeof(T)) - popcount64(mask(Lanes::greater(x, needle)))
+                                    : popcount64(mask(Lanes::greater(needle, x)));
+                }
+                int less = bits / static_cast<int>(sizeof(T));
+                for (; i < count; ++i)
+                {
+                    less += (orEqual ? !(value < items[i]) : items[i] < value) ? 1 : 0;
+                }
+                return less;
+            }
+        };
+
+        template <typename T>
+        constexpr int SearchKernel<T, true>::Width;
+#endif
+
+        /// @brief Binary search without branches on the data: each step is a conditional move, so the loop never
+        ///        mispredicts and runs a fixed number of steps for a given `N`.
+        /// @param upper Find the first element greater than `value` instead of the first one not less than it.
+        template <int N, typename T, typename Compare>
+        inline int branchlessBound(const T *items, const T &value, Compare &compare, bool upper)
+        {
+            const T *base = items;
+            int length = N;
+            while (length > 1)
+            {
+                int half = length / 2;
+#if defined(__GNUC__) || defined(__clang__)
+                if (N * sizeof(T) > PrefetchSearchMinBytes)
+                {
+                    // Fetch both possible next midpoints while this comparison is pending
+                    __builtin_prefetch(base + half / 2);
+                    __builtin_prefetch(base + half + half / 2);
+                }
+#endif
+                bool right = upper ? !compare(value, base[half]) : compare(base[half], value);
+                base = right ? base + half : base;
+                length -= half;
+            }
+            bool after = upper ? !compare(value, *base) : compare(*base, value);
+            return static_cast<int>(base - items) + (after ? 1 : 0);
+        }
+
+        /// @brief Chooses between counting with vector compares for small sorted integer arrays, and binary search.
+        template <bool Count>
+        struct BoundSearch
+        {
+            template <int N, typename T, typename Compare>
+            static int bound(const T *items, const T &value, Compare &compare, bool upper)
+            {
+                return branchlessBound<N>(items, value, compare, upper);
+            }
+        };
+
+#if defined(__AVX2__)
+        template <>
+        struct BoundSearch<true>
+        {
+            template <int N, typename T, typename Compare>
+            static int bound(const T *items, const T &value, Compare &, bool upper)
+            {
+                // In a sorted array, the lower bound is the number of elements less than the value
+                return SearchKernel<T>::countLess(items, N, value, upper);
+            }
+        };
+#endif
+
+        template <int N, typename T, typename Compare>
+        struct CountsBound
+        {
+#if defined(__AVX2__)
+            static constexpr bool value = IsVectorSearchable<T>::value && std::is_same<Compare, Less<T>>::value &&
+                                          N * sizeof(T) <= LinearLowerBoundMaxBytes;
+#else
+            static constexpr bool value = false;
+#endif
+        };
+    }
+
+    /// @brief Finds the first element of an Iterable equal to a value.
+    /// @details Integers are compared 32 bytes at a time with AVX2 when it is enabled, e.g. with `-mavx2` or `-march=native`.
+    /// @param items The elements to search.
+    /// @param value The value to find.
+    /// @return An Option containing the index of the first equal element, or an empty Option if there is none.
+    template <typename T, int N>
+    inline Option<int> find(const Iterable<T, N> &items, const typename detail::NonDeduced<T>::type &value)
+    {
+        int index = detail::SearchKernel<T>::find(items.begin(), N, value);
+        return index < 0 ? Option<int>() : Option<int>(index);
+    }
+
+    /// @brief Finds the first element of an Iterable that matches a predicate.
+    /// @tparam Predicate A callable taking `(const T&)` and returning `bool`.
+    /// @param items The elements to search.
+    /// @param predicate The predicate.
+    /// @return An Option containing the index of the first matching element, or an empty Option if there is none.
+    template <typename T, int N, typename Predicate>
+    inline Option<int> findIf(const Iterable<T, N> &items, Predicate predicate)
+    {
+        for (int i = 0; i < N; ++i)
+        {
+            if (predicate(items.begin()[i]))
+            {
+                return Option<int>(i);
+            }
+        }
+        return Option<int>();
+    }
+
+    /// @brief Counts the elements of an Iterable equal to a value.
+    /// @details Integers are compared 32 bytes at a time with AVX2 when it is enabled.
+    /// @param items The elements to search.
+    /// @param value The value to count.
+    /// @return The number of equal elements.
+    template <typename T, int N>
+    inline int count(const Iterable<T, N> &items, const typename detail::NonDeduced<T>::type &value)
+    {
+        return detail::SearchKernel<T>::count(items.begin(), N, value);
+    }
+
+    /// @brief Counts the elements of an Iterable that match a predicate.
+    /// @tparam Predicate A callable taking `(const T&)` and returning `bool`.
+    /// @param items The elements to search.
+    /// @param predicate The predicate.
+    /// @return The number of matching elements.
+    template <typename T, int N, typename Predicate>
+    inline int countIf(const Iterable<T, N> &items, Predicate predicate)
+    {
+        int matches = 0;
+        for (int i = 0; i < N; ++i)
+        {
+            matches += predicate(items.begin()[i]) ? 1 : 0;
+        }
+        return matches;
+    }
+
+    /// @brief Checks if any element of an Iterable matches a predicate. Stops at the first match.
+    /// @tparam Predicate A callable taking `(const T&)` and returning `bool`.
+    /// @param items The elements to check.
+    /// @param predicate The predicate.
+    /// @return True if at least one element matches.
+    template <typename T, int N, typename Predicate>
+    inline bool anyOf(const Iterable<T, N> &items, Predicate predicate)
+    {
+        return findIf(items, predicate).hasValue();
+    }
+
+    /// @brief Checks if all elements of an Iterable match a predicate. Stops at the first element that does not.
+    /// @tparam Predicate A callable taking `(const T&)` and returning `bool`.
+    /// @param items The elements to check.
+    /// @param predicate The predicate.
+    /// @return True if every element matches.
+    template <typename T, int N, typename Predicate>
+    inline bool allOf(const Iterable<T, N> &items, Predicate predicate)
+    {
+        return !findIf(items, [&predicate](const T &item)
+                       { return !predicate(item); })
+                    .hasValue();
+    }
+
+    /// @brief Checks if no element of an Iterable matches a predicate. Stops at the first match.
+    /// @tparam Predicate A callable taking `(const T&)` and returning `bool`.
+    /// @param items The elements to check.
+    /// @param predicate The predicate.
+    /// @return True if no element matches.
+    template <typename T, int N, typename Predicate>
+    inline bool noneOf(const Iterable<T, N> &items, Predicate predicate)
+    {
+        return !anyOf(items, predicate);
+    }
+
+    /// @brief Finds the first element of a sorted Iterable that is not less than a value.
+    /// @details Searches without branching on the data: each step of the binary search is a conditional move, so the
+    ///          search does not mispredict and always takes `log2(N)` steps. Large arrays prefetch the next midpoints.
+    ///          Small arrays of integers ordered by `Less` are searched by counting the smaller elements with AVX2
+    ///          compares instead, when AVX2 is enabled.
+    /// @tparam Compare The strict weak ordering the Iterable is sorted by.
+    /// @param items The sorted elements to search.
+    /// @param value The value to search for.
+    /// @param compare The ordering, `Less<T>` by default.
+    /// @return The index of the first element not less than `value`, or `N` if all elements are less.
+    template <typename T, int N, typename Compare = Less<T>>
+    inline int lowerBound(const Iterable<T, N> &items, const typename detail::NonDeduced<T>::type &value,
+                          Compare compare = Compare())
+    {
+        return detail::BoundSearch<detail::CountsBound<N, T, Compare>::value>::template bound<N>(items.begin(), value, compare, false);
+    }
+
+    /// @brief Finds the first element of a sorted Iterable that is greater than a value.
+    /// @details Searches as `lowerBound`.
+    /// @tparam Compare The strict weak ordering the Iterable is sorted by.
+    /// @param items The sorted elements to search.
+    /// @param value The value to search for.
+    /// @param compare The ordering, `Less<T>` by default.
+    /// @return The index of the first element greater than `value`, or `N` if no element is greater.
+    template <typename T, int N, typename Compare = Less<T>>
+    inline int upperBound(const Iterable<T, N> &items, const typename detail::NonDeduced<T>::type &value,
+                          Compare compare = Compare())
+    {
+        return detail::BoundSearch<detail::CountsBound<N, T, Compare>::value>::template bound<N>(items.begin(), value, compare, true);
+    }
+
+    /// @brief A read-only map from sorted keys to values, rearranged for fast lookups in large tables.
+    /// @details Binary search over a sorted array touches a new cache line at almost every step, and the next line
+    ///          is not known until the comparison is done. This table stores the keys in Eytzinger order instead: the
+    ///          tree that binary search walks, level by level, with the root at index 1 and the children of node `k`
+    ///          at `2k` and `2k + 1`. The top levels share a few cache lines that stay hot, and the 16 descendants of
+    ///          node `k` four levels down are contiguous at `16k`, so each step prefetches the keys it will compare
+    ///          four steps later. Each step is a conditional move, as in `lowerBound`.
+    ///          Large tables should have static storage, which also keeps the keys aligned to cache lines.
+    /// @tparam K The key type. Must be default constructible and copy assignable.
+    /// @tparam V The value type. Must be default constructible and copy assignable.
+    /// @tparam N The number of entries.
+    /// @tparam Compare The strict weak ordering of the keys.
+    template <typename K, typename V, int N, typename Compare = Less<K>>
+    class StaticSearchTable
+    {
+        static_assert(N > 0, "StaticSearchTable size must be greater than zero");
+
+    private:
+        enum
+        {
+            /// Nodes four levels below node `k` start at `k * PrefetchDescendants`.
+            PrefetchDescendants = 16,
+            CacheLine = 64
+        };
+
+        alignas(CacheLine) K keys_[N + 1];
+        V values_[N + 1];
+        Compare compare_;
+
+        /// @brief Fills the subtree rooted at `node` with the sorted entries from `next` on, in order.
+        /// @return The index of the first entry not placed in the subtree.
+        int layOut(const K *keys, const V *values, int next, long long node)
+        {
+            if (node <= N)
+            {
+                next = layOut(keys, values, next, 2 * node);
+                keys_[node] = keys[next];
+                values_[node] = values[next];
+                next = layOut(keys, values, next + 1, 2 * node + 1);
+            }
+            return next;
+        }
+
+        /// @brief Prefetches the keys of the descendants of `node` four levels down.
+        void prefetchDescendants(unsigned long long node) const
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            // Computed as an integer, since the descendants of the last levels are past the end of the array
+            std::uintptr_t first = reinterpret_cast<std::uintptr_t>(keys_) + node * PrefetchDescendants * sizeof(K);
+            for (std::uintptr_t offset = 0; offset < PrefetchDescendants * sizeof(K); offset += CacheLine)
+            {
+                __builtin_prefetch(reinterpret_cast<const void *>(first + offset));
+            }
+#else
+            (void)node;
+#endif
+        }
+
+        /// @return The node of the first key not less than `key`, or 0 if there is none.
+        unsigned long long lowerBoundNode(const K &key) const
+        {
+            unsigned long long node = 1;
+            while (node <= static_cast<unsigned long long>(N))
+            {
+                prefetchDescendants(node);
+                node = 2 * node + (compare_(keys_[node], key) ? 1 : 0);
+            }
+            // The search went right after the answer; drop those steps and the last left step
+            return node >> (detail::countTrailingZeros64(~node) + 1);
+        }
+
+        /// @return The node of the next key in order after `node`, or 0 if `node` has the last key.
+        static unsigned long long nextNode(unsigned long long node)
+        {
+            if (2 * node + 1 <= static_cast<unsigned long long>(N))
+            {
+                node = 2 * node + 1;
+                while (2 * node <= static_cast<unsigned long long>(N))
+                {
+                    node = 2 * node;
+                }
+                return node;
+            }
+            // Climb while this node is a right child; the next key is at the parent of the first left child
+            return node >> (detail::countTrailingZeros64(~node) + 1);
+        }
+
+    public:
+        /// @brief Constructs a table by rearranging sorted entries.
+        /// @param keys The keys, sorted by `compare`. Lookups in a table built from unsorted keys may miss entries.
+        /// @param values The values, where `values[i]` belongs to `keys[i]`.
+        /// @param compare The ordering of the keys.
+        StaticSearchTable(const Iterable<K, N> &keys, const Iterable<V, N> &values, Compare compare = Compare())
+            : compare_(compare)
+        {
+            layOut(keys.begin(), values.begin(), 0, 1);
+        }
+
+        StaticSearchTable(const StaticSearchTable &) = delete;
+        StaticSearchTable &operator=(const StaticSearchTable &) = delete;
+
+        /// @brief Looks up the value of a key.
+        /// @param key The key to find.
+        /// @return An Option referring to the value of the key, or an empty Option if the key is not in the table.
+        ///         With duplicate keys, the value of the first one.
+        Option<const V &> find(const K &key) const
+        {
+            unsigned long long node = lowerBoundNode(key);
+            if (node == 0 || compare_(key, keys_[node]))
+            {
+                return Option<const V &>();
+            }
+            return Option<const V &>(values_[node]);
+        }
+
+        /// @brief Checks if the table contains a key.
+        /// @param key The key to find.
+        /// @return True if the key is in the table.
+        bool contains(const K &key) const
+        {
+            return find(key).hasValue();
+        }
+
+        /// @brief Visits the entries with keys in `[first, last)` in key order.
+        /// @details Finds `first` as `find` does, then walks the tree in order, so the cost is one lookup plus a few
+        ///          steps per entry visited.
+        /// @param first The smallest key to visit.
+        /// @param last The key to stop before.
+        /// @param func A callable taking `(const K&, const V&)`.
+        /// @return The number of entries visited.
+        template <typename Func>
+        int forEachInRange(const K &first, const K &last, Func func) const
+        {
+            int visited = 0;
+            for (unsigned long long node = lowerBoundNode(first); node != 0 && compare_(keys_[node], last);
+                 node = nextNode(node))
+            {
+                func(keys_[node], values_[node]);
+                ++visited;
+            }
+            return visited;
+        }
+
+        /// @brief Returns the number of entries in the table.
+        int size() const
+        {
+            return N;
+        }
+    };
+}
+
+#endif // FENZ_SEARCH_HPP
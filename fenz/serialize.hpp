@@ -0,0 +1,797 @@
+#include "array.hpp"
+#include "deque.hpp"
+#include "hash.hpp"
+#include "option.hpp"
+#include "queue.hpp"
+#include "time.hpp"
+
+#ifndef FENZ_SERIALIZE_HPP
+#define FENZ_SERIALIZE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace fenz
+{
+    class BinaryWriter;
+    class BinaryReader;
+
+    /// @brief Writes values of type `T` to a BinaryWriter and reads them back from a BinaryReader.
+    /// @details Specialize this for types that are neither trivially copyable nor describe their fields with a static
+    ///          `fields` function. A specialization provides
+    ///          `static void write(BinaryWriter &writer, const T &value)` and
+    ///          `static bool read(BinaryReader &reader, T &value)`, which returns false if the buffer does not hold a
+    ///          valid `T`.
+    /// @tparam T The type to serialize.
+    template <typename T, typename Enable = void>
+    struct Serializer;
+
+    namespace detail
+    {
+        static_assert(sizeof(unsigned int) == 4, "Serialized headers use 32-bit unsigned ints");
+
+        enum
+        {
+            /// The bytes "FZS1" read as a little-endian integer. Buffers written on a machine of the other byte
+            /// order fail the check.
+            SerialMagic = 0x31535A46,
+            SerialVersion = 1,
+            SerialHeaderBytes = 16
+        };
+
+        /// @brief The start of every serialized buffer. The payload follows it.
+        struct SerialHeader
+        {
+            unsigned int magic;
+            unsigned int version;
+            /// The number of bytes after the header.
+            unsigned int length;
+            /// The CRC-32C of the bytes after the header.
+            unsigned int checksum;
+        };
+
+        static_assert(sizeof(SerialHeader) == SerialHeaderBytes, "Serialized headers must not be padded");
+
+        /// @brief Maps signed integers to unsigned ones so that values near zero encode to short varints.
+        inline constexpr unsigned long long zigZagEncode(long long value)
+        {
+            return (static_cast<unsigned long long>(value) << 1) ^ (value < 0 ? ~0ULL : 0ULL);
+        }
+
+        /// @brief Inverts `zigZagEncode`.
+        inline constexpr long long zigZagDecode(unsigned long long value)
+        {
+            return static_cast<long long>((value >> 1) ^ (0ULL - (value & 1)));
+        }
+
+        template <typename... Ts>
+        struct MakeVoid
+        {
+            typedef void type;
+        };
+
+        /// @brief Stands in for the visitor passed to a `fields` function, to detect one.
+        struct FieldProbe
+        {
+            template <typename... Fields>
+            void operator()(Fields &...) {}
+        };
+
+        /// @brief Checks if `T` has a `template <typename Self, typename Visitor> static void fields(Self&, Visitor&)`.
+        template <typename T, typename = void>
+        struct HasFields : std::false_type
+        {
+        };
+
+        template <typename T>
+        struct HasFields<T, typename MakeVoid<decltype(T::fields(std::declval<T &>(), std::declval<FieldProbe &>()))>::type>
+            : std::true_type
+        {
+        };
+
+        /// @brief Checks if elements of type `T` are serialized as they are stored in memory, so that a run of them is
+        ///        written with one copy and can be viewed in place.
+        template <typename T>
+        struct IsBulkSerializable
+            : std::integral_constant<bool, std::is_trivially_copyable<T>::value && !HasFields<T>::value &&
+                                               !std::is_same<typename std::remove_cv<T>::type, bool>::value>
+        {
+        };
+
+        /// @brief Creates a value to read into, for types without a default constructor.
+        template <typename T>
+        struct SerialPlaceholder
+        {
+            static T make() { return T(); }
+        };
+
+        template <typename Rep, typename Period>
+        struct SerialPlaceholder<BasicDuration<Rep, Period>>
+        {
+            static BasicDuration<Rep, Period> make() { return BasicDuration<Rep, Period>::fromTicks(0); }
+        };
+
+        template <typename Rep, typename Period>
+        struct SerialPlaceholder<BasicMoment<Rep, Period>>
+        {
+            static BasicMoment<Rep, Period> make() { return BasicMoment<Rep, Period>::fromTicks(0); }
+        };
+    }
+
+    /// @brief Writes values into a caller-provided buffer, in a compact binary form that BinaryReader can validate.
+    /// @details The first 16 bytes of the buffer are reserved for a header, which `finish` fills in with the length and
+    ///          checksum of everything written. Writing never allocates. If the buffer is too small, the writer stops
+    ///          writing and `finish` fails.
+    ///          Runs of trivially copyable elements are padded to their alignment relative to the start of the
+    ///          buffer, so that a reader can view them in place. Align the buffer itself to the largest such
+    ///          alignment, e.g. with `alignas(16)`.
+    class BinaryWriter
+    {
+    private:
+        unsigned char *data_;
+        int capacity_;
+        int size_;
+        bool overflowed_;
+
+    public:
+        /// @brief Constructs a writer into a buffer.
+        /// @param buffer The buffer to write into. It must outlive the writer.
+        explicit BinaryWriter(Span<unsigned char> buffer)
+            : data_(buffer.data()), capacity_(buffer.size()), size_(detail::SerialHeaderBytes),
+              overflowed_(buffer.size() < detail::SerialHeaderBytes)
+        {
+        }
+
+        /// @brief Constructs a writer into a fixed-size buffer.
+        /// @param buffer The buffer to write into. It must outlive the writer.
+        template <int N>
+        explicit BinaryWriter(Iterable<unsigned char, N> &buffer) : BinaryWriter(Span<unsigned char>(buffer))
+        {
+        }
+
+        /// @brief Writes a value with its Serializer.
+        /// @param value The value to write.
+        /// @return This writer, so that writes can be chained.
+        template <typename T>
+        BinaryWriter &write(const T &value)
+        {
+            Serializer<T>::write(*this, value);
+            return *this;
+        }
+
+        /// @brief Writes raw bytes.
+        /// @param bytes The bytes to write.
+        /// @param size The number of bytes to write.
+        void writeBytes(const void *bytes, int size)
+        {
+            if (overflowed_ || size > capacity_ - size_)
+            {
+                overflowed_ = true;
+                return;
+            }
+            if (size > 0)
+            {
+                std::memcpy(data_ + size_, bytes, static_cast<size_t>(size));
+            }
+            size_ += size;
+        }
+
+        /// @brief Writes an unsigned integer as a LEB128 varint, taking one byte for values below 128.
+        /// @param value The value to write.
+        void writeVarint(unsigned long long value)
+        {
+            if (!overflowed_ && capacity_ - size_ >= 10)
+            {
+                // Room for the longest varint, so write in place without checking each byte
+                while (value >= 0x80)
+                {
+                    data_[size_++] = static_cast<unsigned char>(value | 0x80);
+                    value >>= 7;
+                }
+                data_[size_++] = static_cast<unsigned char>(value);
+                return;
+            }
+            unsigned char bytes[10];
+            int count = 0;
+            while (value >= 0x80)
+            {
+                bytes[count++] = static_cast<unsigned char>(value | 0x80);
+                value >>= 7;
+            }
+            bytes[count++] = static_cast<unsigned char>(value);
+            writeBytes(bytes, count);
+        }
+
+        /// @brief Writes a signed integer as a zig-zag encoded varint, taking one byte for values from -64 to 63.
+        /// @param value The value to write.
+        void writeSigned(long long value)
+        {
+            writeVarint(detail::zigZagEncode(value));
+        }
+
+        /// @brief Writes zero bytes until the position is a multiple of `alignment` from the start of the buffer.
+        /// @param alignment The alignment, a power of two.
+        void align(int alignment)
+        {
+            static const unsigned char zeros[64] = {};
+            int padding = (alignment - size_ % alignment) % alignment;
+            while (padding > 0)
+            {
+                int chunk = padding < 64 ? padding : 64;
+                writeBytes(zeros, chunk);
+                padding -= chunk;
+            }
+        }
+
+        /// @brief Returns the number of bytes used so far, including the header.
+        int size() const { return size_; }
+
+        /// @brief Checks if a write did not fit in the buffer.
+        bool overflowed() const { return overflowed_; }
+
+        /// @brief Fills in the header, so that the buffer can be read with BinaryReader.
+        /// @return An Option containing the total number of bytes to store or send, or an empty Option if the values
+        ///         did not fit in the buffer.
+        Option<int> finish()
+        {
+            if (overflowed_)
+            {
+                return Option<int>();
+            }
+            int length = size_ - detail::SerialHeaderBytes;
+            detail::SerialHeader header = {
+                detail::SerialMagic, detail::SerialVersion, static_cast<unsigned int>(length),
+                crc32c(Span<const unsigned char>(data_ + detail::SerialHeaderBytes, length))};
+            std::memcpy(data_, &header, sizeof(header));
+            return Option<int>(size_);
+        }
+    };
+
+    /// @brief Reads values from a buffer written by BinaryWriter, after validating its header and checksum.
+    /// @details Values are read back in the order they were written, either by copying them out with `read`, or, for
+    ///          runs of trivially copyable elements, by viewing them in place with `view` and `viewSpan`.
+    ///          After a read fails, the position of the reader is unspecified.
+    class BinaryReader
+    {
+    private:
+        const unsigned char *data_;
+        int end_;
+        int position_;
+
+        BinaryReader(const unsigned char *data, int end) : data_(data), end_(end), position_(detail::SerialHeaderBytes)
+        {
+        }
+
+    public:
+        /// @brief Validates a buffer and returns a reader for it.
+        /// @param buffer The buffer, e.g. a mapped file or a received message. It must outlive the reader and any
+        ///        views of it.
+        /// @return An Option containing the reader, or an empty Option if the buffer is too short, was written by a
+        ///         different format version or on a machine of different byte order, or fails its checksum.
+        static Option<BinaryReader> open(Span<const unsigned char> buffer)
+        {
+            detail::SerialHeader header;
+            if (buffer.size() < detail::SerialHeaderBytes)
+            {
+                return Option<BinaryReader>();
+            }
+            std::memcpy(&header, buffer.data(), sizeof(header));
+            if (header.magic != detail::SerialMagic || header.version != detail::SerialVersion ||
+                header.length > static_cast<unsigned int>(buffer.size() - detail::SerialHeaderBytes))
+            {
+                return Option<BinaryReader>();
+            }
+            int length = static_cast<int>(header.length);
+            if (crc32c(Span<const unsigned char>(buffer.data() + detail::SerialHeaderBytes, length)) != header.checksum)
+            {
+                return Option<BinaryReader>();
+            }
+            return Option<BinaryReader>(BinaryReader(buffer.data(), detail::SerialHeaderBytes + length));
+        }
+
+        /// @brief Validates a fixed-size buffer and returns a reader for it.
+        /// @param buffer The buffer. It must outlive the reader and any views of it.
+        /// @return As for the Span overload.
+        template <typename U, int N>
+        static Option<BinaryReader> open(const Iterable<U, N> &buffer)
+        {
+            return open(Span<const unsigned char>(buffer));
+        }
+
+        /// @brief Reads a value with its Serializer.
+        /// @param value Set to the value read.
+        /// @return False if the buffer does not hold a valid value at this position.
+        template <typename T>
+        bool read(T &value)
+        {
+            return Serializer<T>::read(*this, value);
+        }
+
+        /// @brief Returns a pointer to the next `size` bytes and moves past them.
+        /// @param size The number of bytes.
+        /// @return The bytes, or null if fewer than `size` bytes are left.
+        const unsigned char *claim(int size)
+        {
+            if (size < 0 || size > end_ - position_)
+            {
+                return nullptr;
+            }
+            const unsigned char *bytes = data_ + position_;
+            position_ += size;
+            return bytes;
+        }
+
+        /// @brief Reads raw bytes.
+        /// @param bytes Where to copy the bytes.
+        /// @param size The number of bytes to read.
+        /// @return False if fewer than `size` bytes are left.
+        bool readBytes(void *bytes, int size)
+        {
+            const unsigned char *source = claim(size);
+            if (source == nullptr)
+            {
+                return false;
+            }
+            if (size > 0)
+            {
+                std::memcpy(bytes, source, static_cast<size_t>(size));
+            }
+            return true;
+        }
+
+        /// @brief Reads an unsigned integer written by `BinaryWriter::writeVarint`.
+        /// @param value Set to the value read.
+        /// @return False if the varint is truncated or does not fit in 64 bits.
+        bool readVarint(unsigned long long &value)
+        {
+            unsigned long long result = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                if (position_ == end_)
+                {
+                    return false;
+                }
+                unsigned char byte = data_[position_++];
+                if (shift == 63 && byte > 1)
+                {
+                    return false;
+                }
+                result |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    value = result;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// @brief Reads a signed integer written by `BinaryWriter::writeSigned`.
+        /// @param value Set to the value read.
+        /// @return False if the varint is truncated or does not fit in 64 bits.
+        bool readSigned(long long &value)
+        {
+            unsigned long long encoded = 0;
+            if (!readVarint(encoded))
+            {
+                return false;
+            }
+            value = detail::zigZagDecode(encoded);
+            return true;
+        }
+
+        /// @brief Skips the padding written by `BinaryWriter::align`.
+        /// @param alignment The alignment, a power of two.
+        /// @return False if the buffer ends within the padding.
+        bool align(int alignment)
+        {
+            return claim((alignment - position_ % alignment) % alignment) != nullptr;
+        }
+
+        /// @brief Views a serialized Array or Iterable of `N` elements in place, without copying it.
+        /// @tparam T The element type. Must be trivially copyable.
+        /// @tparam N The number of elements.
+        /// @return An Option containing the view, or an empty Option if the buffer ends early or is not aligned for
+        ///         `T`.
+        template <typename T, int N>
+        Option<Iterable<const T, N>> view()
+        {
+            static_assert(detail::IsBulkSerializable<T>::value, "Only trivially copyable elements can be viewed");
+            const unsigned char *bytes = nullptr;
+            if (!align(alignof(T)) || (bytes = claim(static_cast<int>(N * sizeof(T)))) == nullptr ||
+                reinterpret_cast<uintptr_t>(bytes) % alignof(T) != 0)
+            {
+                return Option<Iterable<const T, N>>();
+            }
+            return Option<Iterable<const T, N>>(Iterable<const T, N>(reinterpret_cast<const T *>(bytes)));
+        }
+
+        /// @brief Views a serialized Deque or Queue in place, without copying it.
+        /// @tparam T The element type. Must be trivially copyable.
+        /// @return An Option containing the elements from front to back, or an empty Option if the buffer ends early
+        ///         or is not aligned for `T`.
+        template <typename T>
+        Option<Span<const T>> viewSpan()
+        {
+            static_assert(detail::IsBulkSerializable<T>::value, "Only trivially copyable elements can be viewed");
+            unsigned long long count = 0;
+            if (!readVarint(count) || !align(alignof(T)) ||
+                count > static_cast<unsigned long long>(remaining()) / sizeof(T))
+            {
+                return Option<Span<const T>>();
+            }
+            const unsigned char *bytes = claim(static_cast<int>(count * sizeof(T)));
+            if (reinterpret_cast<uintptr_t>(bytes) % alignof(T) != 0)
+            {
+                return Option<Span<const T>>();
+            }
+            return Option<Span<const T>>(Span<const T>(reinterpret_cast<const T *>(bytes), static_cast<int>(count)));
+        }
+
+        /// @brief Returns the number of bytes left to read.
+        int remaining() const { return end_ - position_; }
+
+        /// @brief Checks if every byte written has been read.
+        bool isComplete() const { return position_ == end_; }
+    };
+
+    namespace detail
+    {
+        /// @brief Writes each field passed to a `fields` function.
+        struct FieldWriter
+        {
+            BinaryWriter &writer;
+
+            template <typename... Fields>
+            void operator()(const Fields &...fields)
+            {
+                int expand[] = {0, (writer.write(fields), 0)...};
+                (void)expand;
+            }
+        };
+
+        /// @brief Reads each field passed to a `fields` function, stopping at the first failure.
+        struct FieldReader
+        {
+            BinaryReader &reader;
+            bool ok;
+
+            template <typename... Fields>
+            void operator()(Fields &...fields)
+            {
+                int expand[] = {0, (ok = ok && reader.read(fields), 0)...};
+                (void)expand;
+            }
+        };
+
+        /// @brief Serializes a type field by field, through its `fields` function.
+        template <typename T, bool Fields = HasFields<T>::value>
+        struct DefaultSerializer
+        {
+            static void write(BinaryWriter &writer, const T &value)
+            {
+                FieldWriter visitor = {writer};
+                T::fields(value, visitor);
+            }
+
+            static bool read(BinaryReader &reader, T &value)
+            {
+                FieldReader visitor = {reader, true};
+                T::fields(value, visitor);
+                return visitor.ok;
+            }
+        };
+
+        /// @brief Serializes a trivially copyable type as its bytes in memory.
+        template <typename T>
+        struct DefaultSerializer<T, false>
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                          "Types that are not trivially copyable need a static fields function or a Serializer "
+                          "specialization");
+
+            static void write(BinaryWriter &writer, const T &value)
+            {
+                writer.writeBytes(&value, sizeof(T));
+            }
+
+            static bool read(BinaryReader &reader, T &value)
+            {
+                return reader.readBytes(&value, sizeof(T));
+            }
+        };
+
+        /// @brief Serializes `count` contiguous elements, with one copy if they are trivially copyable.
+        template <typename T, bool Bulk = IsBulkSerializable<T>::value>
+        struct ElementsSerializer
+        {
+            static void write(BinaryWriter &writer, const T *items, int count)
+            {
+                writer.align(alignof(T));
+                writer.writeBytes(items, static_cast<int>(count * sizeof(T)));
+            }
+
+            static bool read(BinaryReader &reader, T *items, int count)
+            {
+                return reader.align(alignof(T)) && reader.readBytes(items, static_cast<int>(count * sizeof(T)));
+            }
+        };
+
+        template <typename T>
+        struct ElementsSerializer<T, false>
+        {
+            static void write(BinaryWriter &writer, const T *items, int count)
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    writer.write(items[i]);
+                }
+            }
+
+            static bool read(BinaryReader &reader, T *items, int count)
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    if (!reader.read(items[i]))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        };
+
+        /// @brief Reads the element count of a Deque or Queue, and skips to its first element if they were written in
+        ///        bulk.
+        template <typename T>
+        inline bool readSequenceStart(BinaryReader &reader, unsigned int capacity, unsigned int &count)
+        {
+            unsigned long long stored = 0;
+            if (!reader.readVarint(stored) || stored > capacity ||
+                (IsBulkSerializable<T>::value && !reader.align(alignof(T))))
+            {
+                return false;
+            }
+            count = static_cast<unsigned int>(stored);
+            return true;
+        }
+
+        /// @brief Reads the next element of a Deque or Queue.
+        template <typename T>
+        inline bool readSequenceItem(BinaryReader &reader, T &item, std::true_type)
+        {
+            return reader.readBytes(&item, sizeof(T));
+        }
+
+        template <typename T>
+        inline bool readSequenceItem(BinaryReader &reader, T &item, std::false_type)
+        {
+            return reader.read(item);
+        }
+    }
+
+    /// @brief Serializes trivially copyable types as their bytes in memory, and types with a `fields` function field
+    ///        by field.
+    /// @details To serialize a struct field by field, e.g. because it contains Options, give it
+    ///          `template <typename Self, typename Visitor> static void fields(Self &self, Visitor &visit)`, which calls
+    ///          `visit(self.a, self.b, ...)`. `Self` is const when writing.
+    template <typename T, typename Enable>
+    struct Serializer : detail::DefaultSerializer<T>
+    {
+    };
+
+    /// @brief Serializes a bool as one byte, rejecting other byte values when reading.
+    template <>
+    struct Serializer<bool>
+    {
+        static void write(BinaryWriter &writer, bool value)
+        {
+            unsigned char byte = value ? 1 : 0;
+            writer.writeBytes(&byte, 1);
+        }
+
+        static bool read(BinaryReader &reader, bool &value)
+        {
+            unsigned char byte = 0;
+            if (!reader.readBytes(&byte, 1) || byte > 1)
+            {
+                return false;
+            }
+            value = byte == 1;
+            return true;
+        }
+    };
+
+    /// @brief Serializes an Option as a presence byte, followed by the value if there is one.
+    template <typename T>
+    struct Serializer<Option<T>>
+    {
+        static void write(BinaryWriter &writer, const Option<T> &value)
+        {
+            writer.write(value.hasValue());
+            if (value.hasValue())
+            {
+                writer.write(value.value_unsafely());
+            }
+        }
+
+        static bool read(BinaryReader &reader, Option<T> &value)
+        {
+            bool present = false;
+            if (!reader.read(present))
+            {
+                return false;
+            }
+            if (!present)
+            {
+                if (value.hasValue())
+                {
+                    value = Option<T>();
+                }
+                return true;
+            }
+            T item = detail::SerialPlaceholder<T>::make();
+            if (!reader.read(item))
+            {
+                return false;
+            }
+            value = Option<T>(std::move(item));
+            return true;
+        }
+    };
+
+    /// @brief Serializes a Duration as a zig-zag varint of its ticks, so that short durations take one or two bytes.
+    template <typename Rep, typename Period>
+    struct Serializer<BasicDuration<Rep, Period>>
+    {
+        static void write(BinaryWriter &writer, const BasicDuration<Rep, Period> &value)
+        {
+            writer.writeSigned(static_cast<long long>(value.value));
+        }
+
+        static bool read(BinaryReader &reader, BasicDuration<Rep, Period> &value)
+        {
+            long long ticks = 0;
+            if (!reader.readSigned(ticks) || static_cast<long long>(static_cast<Rep>(ticks)) != ticks)
+            {
+                return false;
+            }
+            value = BasicDuration<Rep, Period>::fromTicks(static_cast<Rep>(ticks));
+            return true;
+        }
+    };
+
+    /// @brief Serializes a Moment as a zig-zag varint of its ticks since the start time.
+    template <typename Rep, typename Period>
+    struct Serializer<BasicMoment<Rep, Period>>
+    {
+        static void write(BinaryWriter &writer, const BasicMoment<Rep, Period> &value)
+        {
+            writer.writeSigned(static_cast<long long>(value.value));
+        }
+
+        static bool read(BinaryReader &reader, BasicMoment<Rep, Period> &value)
+        {
+            long long ticks = 0;
+            if (!reader.readSigned(ticks) || static_cast<long long>(static_cast<Rep>(ticks)) != ticks)
+            {
+                return false;
+            }
+            value = BasicMoment<Rep, Period>::fromTicks(static_cast<Rep>(ticks));
+            return true;
+        }
+    };
+
+    /// @brief Serializes the `N` elements of an Iterable, with one copy if they are trivially copyable. Reading
+    ///        overwrites the elements it views.
+    template <typename T, int N>
+    struct Serializer<Iterable<T, N>>
+    {
+        static void write(BinaryWriter &writer, const Iterable<T, N> &value)
+        {
+            detail::ElementsSerializer<typename std::remove_cv<T>::type>::write(writer, value.begin(), N);
+        }
+
+        static bool read(BinaryReader &reader, Iterable<T, N> &value)
+        {
+            return detail::ElementsSerializer<T>::read(reader, value.begin(), N);
+        }
+    };
+
+    /// @brief Serializes the elements of an Array, with one copy if they are trivially copyable.
+    template <typename T, int N>
+    struct Serializer<Array<T, N>> : Serializer<Iterable<T, N>>
+    {
+    };
+
+    /// @brief Serializes a Deque as its number of items followed by its items from front to back, with one copy per
+    ///        contiguous segment if they are trivially copyable.
+    template <typename T, unsigned int Capacity>
+    struct Serializer<Deque<T, Capacity>>
+    {
+        static void write(BinaryWriter &writer, const Deque<T, Capacity> &value)
+        {
+            DequeSegments<const T> segments = value.segments();
+            writer.writeVarint(value.size());
+            detail::ElementsSerializer<T>::write(writer, segments.first.data(), segments.first.size());
+            // The second segment follows the first without padding, as its elements are already aligned
+            if (detail::IsBulkSerializable<T>::value)
+            {
+                writer.writeBytes(segments.second.data(), static_cast<int>(segments.second.size() * sizeof(T)));
+            }
+            else
+            {
+                detail::ElementsSerializer<T>::write(writer, segments.second.data(), segments.second.size());
+            }
+        }
+
+        /// @details Reading replaces the contents of `value`, and fails if there are more items than `Capacity`.
+        static bool read(BinaryReader &reader, Deque<T, Capacity> &value)
+        {
+            unsigned int count = 0;
+            if (!detail::readSequenceStart<T>(reader, Capacity, count))
+            {
+                return false;
+            }
+            value.clear();
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                T item = detail::SerialPlaceholder<T>::make();
+                if (!detail::readSequenceItem(reader, item, detail::IsBulkSerializable<T>()))
+                {
+                    return false;
+                }
+                value.pushBack(item);
+            }
+            return true;
+        }
+    };
+
+    /// @brief Serializes a Queue as its number of items followed by its items from front to back.
+    /// @details Queue stores each item in an Option, so trivially copyable items are copied one at a time, but into
+    ///          one contiguous run that can be viewed in place with `BinaryReader::viewSpan`, as for a Deque.
+    template <typename T, unsigned int Capacity>
+    struct Serializer<Queue<T, Capacity>>
+    {
+        static void write(BinaryWriter &writer, const Queue<T, Capacity> &value)
+        {
+            writer.writeVarint(value.size());
+            if (detail::IsBulkSerializable<T>::value)
+            {
+                writer.align(alignof(T));
+                value.enumerate([&writer](const T &item, int)
+                                { writer.writeBytes(&item, sizeof(T)); });
+            }
+            else
+            {
+                value.enumerate([&writer](const T &item, int)
+                                { writer.write(item); });
+            }
+        }
+
+        /// @details Reading replaces the contents of `value`, and fails if there are more items than `Capacity`.
+        static bool read(BinaryReader &reader, Queue<T, Capacity> &value)
+        {
+            unsigned int count = 0;
+            if (!detail::readSequenceStart<T>(reader, Capacity, count))
+            {
+                return false;
+            }
+            value.dequeueAll([](const T &) {});
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                T item = detail::SerialPlaceholder<T>::make();
+                if (!detail::readSequenceItem(reader, item, detail::IsBulkSerializable<T>()))
+                {
+                    return false;
+                }
+                value.enqueue(item);
+            }
+            return true;
+        }
+    };
+}
+
+#endif // FENZ_SERIALIZE_HPP
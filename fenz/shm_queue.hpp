@@ -0,0 +1,413 @@
+#include "futex.hpp"
+#include "option.hpp"
+#include "time.hpp"
+
+#ifndef FENZ_SHM_QUEUE_HPP
+#define FENZ_SHM_QUEUE_HPP
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fenz
+{
+    namespace detail
+    {
+        static_assert(ATOMIC_INT_LOCK_FREE == 2, "Shared memory queues need lock-free atomics, which work across processes");
+
+        enum
+        {
+            ShmQueueVersion = 1
+        };
+
+        /// The first word of every shared memory queue: "FENZSHMQ".
+        constexpr unsigned long long ShmQueueMagic = 0x514D48535A4E4546ULL;
+
+        /// @brief The contents of the shared memory segment of a ShmQueue.
+        /// @details The header describes the layout, so that a process built with a different element type, capacity
+        ///          or version of this library refuses to open the queue. The consumer's and the producer's positions
+        ///          are on separate cache lines, so that each side only writes to its own line.
+        template <typename T, unsigned int Capacity>
+        struct ShmQueueLayout
+        {
+            /// Written last when the queue is created, so that a process that sees it also sees the rest of the header.
+            std::atomic<unsigned long long> magic;
+            unsigned int version;
+            unsigned int capacity;
+            unsigned int elementSize;
+            unsigned int elementAlignment;
+            unsigned int wakeups;
+
+            /// The position of the next item to dequeue. Written by the consumer; producers wait on it when full.
+            alignas(64) std::atomic<unsigned int> head;
+            /// Set while the producer is blocked on `head`.
+            std::atomic<unsigned int> producerWaiting;
+
+            /// The position of the next item to enqueue. Written by the producer; consumers wait on it when empty.
+            alignas(64) std::atomic<unsigned int> tail;
+            /// Set while the consumer is blocked on `tail`.
+            std::atomic<unsigned int> consumerWaiting;
+
+            alignas(64) T slots[Capacity];
+        };
+    }
+
+    /// @brief A single-producer, single-consumer queue in named shared memory, for passing items between processes
+    ///        on the same host.
+    /// @details Items are copied into the shared segment once and read from it in place, with no system calls in the
+    ///          common case: the producer and the consumer only synchronize through their positions. A side that
+    ///          waits spins briefly, then blocks on a futex, and the other side only makes a wake-up system call when
+    ///          it is actually blocked. Without wake-ups, publishing an item needs no fence, and the queue can
+    ///          only be polled.
+    ///          One process creates the queue by name and the other opens it. Opening fails unless the segment was
+    ///          created with the same element size, alignment and capacity, and the same version of this layout.
+    /// @tparam T The type of items. Must be trivially copyable, and must not contain pointers, since the processes
+    ///         map the segment at different addresses.
+    /// @tparam Capacity The maximum number of items in the queue. Must be a power of two.
+    /// @tparam Wakeups Whether a side can block until the other makes progress, with `enqueueWait` and `dequeueWait`.
+    ///         Both processes must agree.
+    /// @note Exactly one thread, in any process, may enqueue, and exactly one may dequeue. Timeouts are measured with
+    ///       `Moment::now()`, so `fenzTimeSource` must be defined to use the waiting functions.
+    /// @note On older glibc versions, `shm_open` requires linking with `-lrt`.
+    template <typename T, unsigned int Capacity, bool Wakeups = true>
+    class ShmQueue
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "ShmQueue items must be trivially copyable");
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "ShmQueue capacity must be a power of two");
+        static_assert(Capacity <= 0x80000000u, "ShmQueue capacity must fit positions that wrap around at 2^32");
+
+    private:
+        typedef detail::ShmQueueLayout<T, Capacity> Layout;
+
+        /// The number of times a waiting side polls the queue before blocking.
+        static constexpr int SpinCount = 256;
+
+        Layout *layout_;
+        /// The last `head` seen by the producer, so that it only reads the consumer's line when it looks full.
+        unsigned int cachedHead_;
+        /// The last `tail` seen by the consumer, so that it only reads the producer's line when it looks empty.
+        unsigned int cachedTail_;
+
+        explicit ShmQueue(Layout *layout) : layout_(layout), cachedHead_(0), cachedTail_(0) {}
+
+        /// @brief Publishes a new position, and wakes the other side if it is blocked on it.
+        static void publish(std::atomic<unsigned int> &position, unsigned int value, std::atomic<unsigned int> &waiting)
+        {
+            position.store(value, std::memory_order_release);
+            if (!Wakeups)
+            {
+                return;
+            }
+            // Orders the store before the load, so that either the waiter sees the new position or we see it waiting
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiting.load(std::memory_order_relaxed) != 0)
+            {
+                futexWake(position, 1, true);
+            }
+        }
+
+        /// @brief Calls `attempt` until it succeeds, blocking on `position` between attempts, or until the timeout passes.
+        template <typename Result, typename Attempt>
+        static Result waitFor(Attempt attempt, std::atomic<unsigned int> &position, std::atomic<unsigned int> &waiting,
+                              Duration timeout)
+        {
+            for (int spin = 0; spin < SpinCount; ++spin)
+            {
+                Result result = attempt();
+                if (result)
+                {
+                    return result;
+                }
+                cpuRelax();
+            }
+
+            const Moment deadline = Moment::now() + timeout;
+            while (true)
+            {
+                unsigned int seen = position.load(std::memory_order_seq_cst);
+                Result result = attempt();
+                if (result)
+                {
+                    return result;
+                }
+
+                Duration remaining = deadline - Moment::now();
+                if (remaining <= Duration::fromMillis(0))
+                {
+                    return result;
+                }
+
+                waiting.store(1, std::memory_order_seq_cst);
+                if (position.load(std::memory_order_seq_cst) == seen)
+                {
+                    futexWait(position, seen, remaining, true);
+                }
+                waiting.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        /// @brief Maps a shared memory segment of the size of the layout.
+        /// @return The mapping, or nullptr on failure. The descriptor is closed either way.
+        static Layout *mapSegment(int descriptor)
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            void *address = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+            ::close(descriptor);
+            return address == MAP_FAILED ? nullptr : static_cast<Layout *>(address);
+#else
+            (void)descriptor;
+            return nullptr;
+#endif
+        }
+
+    public:
+        ShmQueue(ShmQueue &&other) : layout_(other.layout_), cachedHead_(other.cachedHead_), cachedTail_(other.cachedTail_)
+        {
+            other.layout_ = nullptr;
+        }
+
+        ShmQueue(const ShmQueue &) = delete;
+        ShmQueue &operator=(const ShmQueue &) = delete;
+
+        /// @brief Unmaps the queue. The segment stays until it is removed with `remove`.
+        ~ShmQueue()
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            if (layout_ != nullptr)
+            {
+                munmap(layout_, sizeof(Layout));
+            }
+#endif
+        }
+
+        /// @brief Creates an empty queue in a new shared memory segment.
+        /// @param name The name of the segment, e.g. `"/frames"`: a slash followed by up to 254 other characters.
+        /// @return An Option containing the queue, or an empty Option if the segment already exists or could not be
+        ///         created.
+        static Option<ShmQueue> create(const char *name)
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            int descriptor = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (descriptor < 0)
+            {
+                return Option<ShmQueue>();
+            }
+            if (ftruncate(descriptor, static_cast<off_t>(sizeof(Layout))) != 0)
+            {
+                ::close(descriptor);
+                shm_unlink(name);
+                return Option<ShmQueue>();
+            }
+            Layout *layout = mapSegment(descriptor);
+            if (layout == nullptr)
+            {
+                shm_unlink(name);
+                return Option<ShmQueue>();
+            }
+
+            // The segment starts zeroed, so only the atomics need constructing
+            new (&layout->head) std::atomic<unsigned int>(0);
+            new (&layout->producerWaiting) std::atomic<unsigned int>(0);
+            new (&layout->tail) std::atomic<unsigned int>(0);
+            new (&layout->consumerWaiting) std::atomic<unsigned int>(0);
+            layout->version = detail::ShmQueueVersion;
+            layout->capacity = Capacity;
+            layout->elementSize = sizeof(T);
+            layout->elementAlignment = alignof(T);
+            layout->wakeups = Wakeups ? 1 : 0;
+            new (&layout->magic) std::atomic<unsigned long long>(0);
+            layout->magic.store(detail::ShmQueueMagic, std::memory_order_release);
+            return Option<ShmQueue>(ShmQueue(layout));
+#else
+            (void)name;
+            return Option<ShmQueue>();
+#endif
+        }
+
+        /// @brief Opens a queue created by another process.
+        /// @param name The name the queue was created with.
+        /// @return An Option containing the queue, or an empty Option if there is no such segment, if it is not fully
+        ///         created yet, or if it was created with a different element type, capacity, wake-up setting or
+        ///         layout version.
+        static Option<ShmQueue> open(const char *name)
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            int descriptor = shm_open(name, O_RDWR, 0);
+            if (descriptor < 0)
+            {
+                return Option<ShmQueue>();
+            }
+            struct stat status;
+            if (fstat(descriptor, &status) != 0 || status.st_size != static_cast<off_t>(sizeof(Layout)))
+            {
+                ::close(descriptor);
+                return Option<ShmQueue>();
+            }
+            Layout *layout = mapSegment(descriptor);
+            if (layout == nullptr)
+            {
+                return Option<ShmQueue>();
+            }
+            ShmQueue queue(layout);
+            if (layout->magic.load(std::memory_order_acquire) != detail::ShmQueueMagic ||
+                layout->version != detail::ShmQueueVersion || layout->capacity != Capacity ||
+                layout->elementSize != sizeof(T) || layout->elementAlignment != alignof(T) || layout->wakeups != (Wakeups ? 1u : 0u))
+            {
+                return Option<ShmQueue>();
+            }
+            queue.cachedHead_ = layout->head.load(std::memory_order_acquire);
+            queue.cachedTail_ = layout->tail.load(std::memory_order_acquire);
+            return Option<ShmQueue>(std::move(queue));
+#else
+            (void)name;
+            return Option<ShmQueue>();
+#endif
+        }
+
+        /// @brief Removes a queue's name, so that no other process can open it. Processes that have it open can
+        ///        keep using it, and the memory is freed when the last one unmaps it.
+        /// @param name The name the queue was created with.
+        /// @return True if the name was removed, false if there was no such queue.
+        static bool remove(const char *name)
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            return shm_unlink(name) == 0;
+#else
+            (void)name;
+            return false;
+#endif
+        }
+
+        /// @brief Adds an item to the back of the queue without waiting. Only call from the producer.
+        /// @param item The item to add.
+        /// @return True if the item was added, false if the queue is full.
+        bool enqueue(const T &item)
+        {
+            return enqueueWith([&item](T &slot)
+                               { slot = item; });
+        }
+
+        /// @brief Adds an item to the back of the queue by filling its slot in place, without waiting. Only call
+        ///        from the producer.
+        /// @details Avoids copying large items through a temporary, e.g. when reading a frame straight into the queue.
+        /// @param fill A callable taking `(T&)`: the slot to fill, which holds an old item.
+        /// @return True if the item was added, false if the queue is full and `fill` was not called.
+        template <typename Fill>
+        bool enqueueWith(Fill fill)
+        {
+            unsigned int tail = layout_->tail.load(std::memory_order_relaxed);
+            if (tail - cachedHead_ == Capacity)
+            {
+                cachedHead_ = layout_->head.load(std::memory_order_acquire);
+                if (tail - cachedHead_ == Capacity)
+                {
+                    return false;
+                }
+            }
+            fill(layout_->slots[tail & (Capacity - 1)]);
+            publish(layout_->tail, tail + 1, layout_->consumerWaiting);
+            return true;
+        }
+
+        /// @brief Adds an item to the back of the queue, waiting for space if the queue is full. Only call from the
+        ///        producer.
+        /// @param item The item to add.
+        /// @param timeout The maximum time to wait for space.
+        /// @return True if the item was added, false if the queue stayed full until the timeout passed.
+        bool enqueueWait(const T &item, Duration timeout)
+        {
+            static_assert(Wakeups, "Waiting needs a ShmQueue with wake-ups");
+            return waitFor<bool>([this, &item]()
+                                 { return enqueue(item); },
+                                 layout_->head, layout_->producerWaiting, timeout);
+        }
+
+        /// @brief Removes and returns the item at the front of the queue without waiting. Only call from the consumer.
+        /// @return An Option containing the item if the queue is not empty, or an empty Option if the queue is empty.
+        Option<T> dequeue()
+        {
+            Option<T> item;
+            dequeueWith([&item](const T &slot)
+                        { item = slot; });
+            return item;
+        }
+
+        /// @brief Removes the item at the front of the queue after reading it in place, without waiting. Only call
+        ///        from the consumer.
+        /// @param read A callable taking `(const T&)`: the item. The slot is only reused after `read` returns.
+        /// @return True if an item was read and removed, false if the queue is empty and `read` was not called.
+        template <typename Read>
+        bool dequeueWith(Read read)
+        {
+            unsigned int head = layout_->head.load(std::memory_order_relaxed);
+            if (head == cachedTail_)
+            {
+                cachedTail_ = layout_->tail.load(std::memory_order_acquire);
+                if (head == cachedTail_)
+                {
+                    return false;
+                }
+            }
+            read(static_cast<const T &>(layout_->slots[head & (Capacity - 1)]));
+            publish(layout_->head, head + 1, layout_->producerWaiting);
+            return true;
+        }
+
+        /// @brief Removes and returns the item at the front of the queue, waiting for an item if the queue is empty.
+        ///        Only call from the consumer.
+        /// @param timeout The maximum time to wait for an item.
+        /// @return An Option containing the item, or an empty Option if the queue stayed empty until the timeout passed.
+        Option<T> dequeueWait(Duration timeout)
+        {
+            static_assert(Wakeups, "Waiting needs a ShmQueue with wake-ups");
+            return waitFor<Option<T>>([this]()
+                                      { return dequeue(); },
+                                      layout_->tail, layout_->consumerWaiting, timeout);
+        }
+
+        /// @brief Returns the number of items in the queue.
+        /// @return The number of items in the queue.
+        /// @note The result is only a snapshot while the other side is using the queue.
+        unsigned int size() const
+        {
+            unsigned int head = layout_->head.load(std::memory_order_acquire);
+            return layout_->tail.load(std::memory_order_acquire) - head;
+        }
+
+        /// @brief Returns the maximum capacity of the queue.
+        /// @return The maximum capacity of the queue.
+        constexpr unsigned int capacity() const
+        {
+            return Capacity;
+        }
+
+        /// @brief Checks if the queue is full.
+        /// @return True if the queue is full, false otherwise.
+        /// @note The result is only a snapshot while the other side is using the queue.
+        bool isFull() const
+        {
+            return size() == Capacity;
+        }
+
+        /// @brief Checks if the queue is empty.
+        /// @return True if the queue is empty, false otherwise.
+        /// @note The result is only a snapshot while the other side is using the queue.
+        bool isEmpty() const
+        {
+            return size() == 0;
+        }
+    };
+
+    template <typename T, unsigned int Capacity, bool Wakeups>
+    constexpr int ShmQueue<T, Capacity, Wakeups>::SpinCount;
+}
+
+#endif // FENZ_SHM_QUEUE_HPP
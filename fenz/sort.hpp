@@ -0,0 +1,1519 @@
+#include "array.hpp"
+#include "functional.hpp"
+#include "scheduler.hpp"
+
+#ifndef FENZ_SORT_HPP
+#define FENZ_SORT_HPP
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace fenz
+{
+    namespace detail
+    {
+        enum
+        {
+            /// Arrays up to this size are sorted with a sorting network.
+            NetworkSortMaxSize = 16,
+            /// Ranges below this size are finished with insertion sort.
+            InsertionSortThreshold = 24,
+            /// Ranges above this size pick their pivot as the median of three medians.
+            NintherThreshold = 128,
+            /// The number of elements partial insertion sort may move before giving up.
+            PartialInsertionSortLimit = 8,
+            /// Ranges up to this size are sorted sequentially by the parallel sorts.
+            ParallelSortGrain = 1 << 14,
+            /// The length of the runs merge sort builds with insertion sort.
+            MergeSortRun = 32,
+            /// The number of elements block partitioning compares before swapping.
+            PartitionBlockSize = 64
+        };
+
+        /// @brief True if comparing `T`s with `Compare` is cheap and has no side effects, so partitioning can compare
+        ///        whole blocks up front and swap without branching on the results.
+        template <typename T, typename Compare>
+        struct IsBranchlessCompare
+        {
+            static constexpr bool value = false;
+        };
+
+        template <typename T>
+        struct IsBranchlessCompare<T, Less<T>>
+        {
+            static constexpr bool value = std::is_arithmetic<T>::value;
+        };
+
+        template <typename T>
+        struct IsBranchlessCompare<T, Greater<T>>
+        {
+            static constexpr bool value = std::is_arithmetic<T>::value;
+        };
+
+        template <typename T, typename Compare>
+        inline void compareExchange(T &a, T &b, Compare &compare)
+        {
+            // Both selects compile to conditional moves for scalars, so networks do not branch on the data
+            bool swap = compare(b, a);
+            T low = swap ? b : a;
+            T high = swap ? a : b;
+            a = std::move(low);
+            b = std::move(high);
+        }
+
+        /// @brief A fixed sequence of compare-exchanges on `N` elements, built at compile time.
+        template <int N>
+        struct ComparatorNetwork
+        {
+            static constexpr int MaxSize = N * N;
+
+            int size;
+            unsigned char low[MaxSize];
+            unsigned char high[MaxSize];
+
+            constexpr ComparatorNetwork() : size(0), low{}, high{} {}
+
+            constexpr void add(int a, int b)
+            {
+                low[size] = static_cast<unsigned char>(a);
+                high[size] = static_cast<unsigned char>(b);
+                ++size;
+            }
+        };
+
+        /// @brief The best known sorting networks for 2 to 16 elements. The ones up to 12 elements are proven optimal.
+        template <typename Unused = void>
+        struct NetworkTables
+        {
+            static constexpr int MaxSize = 16;
+
+            /// The compare-exchanges of all networks as pairs of indices, one layer of independent pairs per line.
+            static constexpr unsigned char pairs[] = {
+                // 2 elements
+                0, 1,
+                // 3 elements
+                0, 2,
+                0, 1,
+                1, 2,
+                // 4 elements
+                0, 1, 2, 3,
+                0, 2, 1, 3,
+                1, 2,
+                // 5 elements
+                0, 1, 3, 4,
+                2, 4,
+                2, 3, 1, 4,
+                0, 3,
+                0, 2, 1, 3,
+                1, 2,
+                // 6 elements
+                1, 2, 4, 5,
+                0, 2, 3, 5,
+                0, 1, 3, 4, 2, 5,
+                0, 3, 1, 4,
+                2, 4, 1, 3,
+                2, 3,
+                // 7 elements
+                1, 2, 3, 4, 5, 6,
+                0, 2, 3, 5, 4, 6,
+                0, 1, 4, 5, 2, 6,
+                0, 4, 1, 5,
+                0, 3, 2, 5,
+                1, 3, 2, 4,
+                2, 3,
+                // 8 elements
+                0, 2, 1, 3, 4, 6, 5, 7,
+                0, 4, 1, 5, 2, 6, 3, 7,
+                0, 1, 2, 3, 4, 5, 6, 7,
+                2, 4, 3, 5,
+                1, 4, 3, 6,
+                1, 2, 3, 4, 5, 6,
+                // 9 elements
+                0, 3, 1, 7, 2, 5, 4, 8,
+                0, 7, 2, 4, 3, 8, 5, 6,
+                0, 2, 1, 3, 4, 5, 7, 8,
+                1, 4, 3, 6, 5, 7,
+                0, 1, 2, 4, 3, 5, 6, 8,
+                2, 3, 4, 5, 6, 7,
+                1, 2, 3, 4, 5, 6,
+                // 10 elements
+                0, 8, 1, 9, 2, 7, 3, 5, 4, 6,
+                0, 2, 1, 4, 5, 8, 7, 9,
+                0, 3, 2, 4, 5, 7, 6, 9,
+                0, 1, 3, 6, 8, 9,
+                1, 5, 2, 3, 4, 8, 6, 7,
+                1, 2, 3, 5, 4, 6, 7, 8,
+                2, 3, 4, 5, 6, 7,
+                3, 4, 5, 6,
+                // 11 elements
+                0, 9, 1, 6, 2, 4, 3, 7, 5, 8,
+                0, 1, 3, 5, 4, 10, 6, 9, 7, 8,
+                1, 3, 2, 5, 4, 7, 8, 10,
+                0, 4, 1, 2, 3, 7, 5, 9, 6, 8,
+                0, 1, 2, 6, 4, 5, 7, 8, 9, 10,
+                2, 4, 3, 6, 5, 7, 8, 9,
+                1, 2, 3, 4, 5, 6, 7, 8,
+                2, 3, 4, 5, 6, 7,
+                // 12 elements
+                0, 8, 1, 7, 2, 6, 3, 11, 4, 10, 5, 9,
+                0, 1, 2, 5, 3, 4, 6, 9, 7, 8, 10, 11,
+                0, 2, 1, 6, 5, 10, 9, 11,
+                0, 3, 1, 2, 4, 6, 5, 7, 8, 11, 9, 10,
+                1, 4, 3, 5, 6, 8, 7, 10,
+                1, 3, 2, 5, 6, 9, 8, 10,
+                2, 3, 4, 5, 6, 7, 8, 9,
+                4, 6, 5, 7,
+                3, 4, 5, 6, 7, 8,
+                // 13 elements
+                0, 12, 1, 10, 2, 9, 3, 7, 5, 11, 6, 8,
+                1, 6, 2, 3, 4, 11, 7, 9, 8, 10,
+                0, 4, 1, 2, 3, 6, 7, 8, 9, 10, 11, 12,
+                4, 6, 5, 9, 8, 11, 10, 12,
+                0, 5, 3, 8, 4, 7, 6, 11, 9, 10,
+                0, 1, 2, 5, 6, 9, 7, 8, 10, 11,
+                1, 3, 2, 4, 5, 6, 9, 10,
+                1, 2, 3, 4, 5, 7, 6, 8,
+                2, 3, 4, 5, 6, 7, 8, 9,
+                3, 4, 5, 6,
+                // 14 elements
+                0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+                0, 2, 1, 3, 4, 8, 5, 9, 10, 12, 11, 13,
+                0, 4, 1, 2, 3, 7, 5, 8, 6, 10, 9, 13, 11, 12,
+                0, 6, 1, 5, 3, 9, 4, 10, 7, 13, 8, 12,
+                2, 10, 3, 11, 4, 6, 7, 9,
+                1, 3, 2, 8, 5, 11, 6, 7, 10, 12,
+                1, 4, 2, 6, 3, 5, 7, 11, 8, 10, 9, 12,
+                2, 4, 3, 6, 5, 8, 7, 10, 9, 11,
+                3, 4, 5, 6, 7, 8, 9, 10,
+                6, 7,
+                // 15 elements
+                0, 13, 1, 12, 3, 14, 4, 8, 5, 6, 7, 11, 9, 10,
+                0, 5, 1, 7, 2, 9, 3, 4, 6, 13, 8, 14, 11, 12,
+                0, 1, 2, 3, 4, 5, 6, 8, 7, 9, 10, 11, 12, 13,
+                0, 2, 1, 3, 4, 10, 5, 11, 6, 7, 8, 9, 12, 14,
+                1, 2, 3, 12, 4, 6, 5, 7, 8, 10, 9, 11, 13, 14,
+                1, 4, 2, 6, 5, 8, 7, 10, 9, 13, 11, 14,
+                2, 4, 3, 6, 9, 12, 11, 13,
+                3, 5, 6, 8, 7, 9, 10, 12,
+                3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+                6, 7, 8, 9,
+                // 16 elements
+                0, 13, 1, 12, 2, 15, 3, 14, 4, 8, 5, 6, 7, 11, 9, 10,
+                0, 5, 1, 7, 2, 9, 3, 4, 6, 13, 8, 14, 10, 15, 11, 12,
+                0, 1, 2, 3, 4, 5, 6, 8, 7, 9, 10, 11, 12, 13, 14, 15,
+                0, 2, 1, 3, 4, 10, 5, 11, 6, 7, 8, 9, 12, 14, 13, 15,
+                1, 2, 3, 12, 4, 6, 5, 7, 8, 10, 9, 11, 13, 14,
+                1, 4, 2, 6, 5, 8, 7, 10, 9, 13, 11, 14,
+                2, 4, 3, 6, 9, 12, 11, 13,
+                3, 5, 6, 8, 7, 9, 10, 12,
+                3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+                6, 7, 8, 9};
+
+            /// Where the network for `n` elements starts in `pairs`, counted in pairs.
+            static constexpr int offsets[] = {0, 0, 0, 1, 4, 9, 18, 30, 46, 65, 90, 119, 154, 193, 238, 289, 345, 405};
+        };
+
+        template <typename Unused>
+        constexpr unsigned char NetworkTables<Unused>::pairs[];
+
+        template <typename Unused>
+        constexpr int NetworkTables<Unused>::offsets[];
+
+        /// @brief Returns a sorting network for `N` elements: the best known one up to 16 elements, and Batcher's
+        ///        odd-even merge network above that.
+        template <int N>
+        constexpr ComparatorNetwork<N> makeSortingNetwork()
+        {
+            ComparatorNetwork<N> network;
+            if (N <= NetworkTables<>::MaxSize)
+            {
+                for (int i = NetworkTables<>::offsets[N]; i < NetworkTables<>::offsets[N + 1]; ++i)
+                {
+                    network.add(NetworkTables<>::pairs[2 * i], NetworkTables<>::pairs[2 * i + 1]);
+                }
+                return network;
+            }
+
+            for (int p = 1; p < N; p <<= 1)
+            {
+                for (int k = p; k >= 1; k >>= 1)
+                {
+                    for (int j = k % p; j + k < N; j += 2 * k)
+                    {
+                        for (int i = 0; i < k && i + j + k < N; ++i)
+                        {
+                            if ((i + j) / (2 * p) == (i + j + k) / (2 * p))
+                            {
+                                network.add(i + j, i + j + k);
+                            }
+                        }
+                    }
+                }
+            }
+            return network;
+        }
+
+        /// @brief Returns the part of the sorting network for `N` elements that places the elements at `first` to `last - 1`.
+        /// @details Walks the network backwards from those outputs and keeps only the compare-exchanges they depend on.
+        ///          The kept ones still permute the elements, so the other outputs hold the remaining elements unordered.
+        template <int N>
+        constexpr ComparatorNetwork<N> makeSelectionNetwork(int first, int last)
+        {
+            ComparatorNetwork<N> full = makeSortingNetwork<N>();
+            bool keep[ComparatorNetwork<N>::MaxSize] = {};
+            unsigned long long needed = 0;
+            for (int wire = first; wire < last; ++wire)
+            {
+                needed |= 1ULL << wire;
+            }
+            for (int i = full.size - 1; i >= 0; --i)
+            {
+                unsigned long long wires = (1ULL << full.low[i]) | (1ULL << full.high[i]);
+                if ((needed & wires) != 0)
+                {
+                    keep[i] = true;
+                    needed |= wires;
+                }
+            }
+
+            ComparatorNetwork<N> selection;
+            for (int i = 0; i < full.size; ++i)
+            {
+                if (keep[i])
+                {
+                    selection.add(full.low[i], full.high[i]);
+                }
+            }
+            return selection;
+        }
+
+        /// @brief Checks that the sorting network for `N` elements sorts every input of zeros and ones, which by the 0-1
+        ///        principle means that it sorts every input.
+        /// @details All 2^N inputs are run at once, one bit per input, so each compare-exchange is an AND and an OR.
+        template <int N>
+        constexpr bool sortsAllZeroOneInputs()
+        {
+            const int Words = N <= 6 ? 1 : 1 << (N - 6);
+            const unsigned long long patterns[6] = {0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+                                                    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL};
+            unsigned long long wires[N][Words] = {};
+            for (int wire = 0; wire < N; ++wire)
+            {
+                for (int word = 0; word < Words; ++word)
+                {
+                    // Bit `x` of wire `w` is bit `w` of input `x`
+                    wires[wire][word] = wire < 6 ? patterns[wire] : (((word >> (wire - 6)) & 1) != 0 ? ~0ULL : 0ULL);
+                }
+            }
+
+            ComparatorNetwork<N> network = makeSortingNetwork<N>();
+            for (int i = 0; i < network.size; ++i)
+            {
+                for (int word = 0; word < Words; ++word)
+                {
+                    unsigned long long a = wires[network.low[i]][word];
+                    unsigned long long b = wires[network.high[i]][word];
+                    wires[network.low[i]][word] = a & b;
+                    wires[network.high[i]][word] = a | b;
+                }
+            }
+
+            for (int wire = 0; wire + 1 < N; ++wire)
+            {
+                for (int word = 0; word < Words; ++word)
+                {
+                    if ((wires[wire][word] & ~wires[wire + 1][word]) != 0)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        template <int N, bool Tabled = (N <= NetworkTables<>::MaxSize)>
+        struct NetworkCheck
+        {
+            // Batcher's networks are correct by construction, and too large to check exhaustively
+            static constexpr bool value = true;
+        };
+
+        template <int N>
+        struct NetworkCheck<N, true>
+        {
+            static constexpr bool value = sortsAllZeroOneInputs<N>();
+        };
+
+        /// @brief The network that places the elements at `First` to `Last - 1` among `N` elements.
+        template <int N, int First, int Last>
+        struct NetworkTable
+        {
+            static_assert(NetworkCheck<N>::value, "The sorting network does not sort all inputs");
+
+            static constexpr ComparatorNetwork<N> value = makeSelectionNetwork<N>(First, Last);
+        };
+
+        template <int N, int First, int Last>
+        constexpr ComparatorNetwork<N> NetworkTable<N, First, Last>::value;
+
+        /// @brief Applies compare-exchange `Index` of a network and the ones after it, unrolled so that every index
+        ///        is a constant.
+        template <typename Network, int Index = 0, int Size = Network::value.size>
+        struct NetworkStep
+        {
+            template <typename T, typename Compare>
+            static void apply(T *items, Compare &compare)
+            {
+                compareExchange(items[Network::value.low[Index]], items[Network::value.high[Index]], compare);
+                NetworkStep<Network, Index + 1, Size>::apply(items, compare);
+            }
+        };
+
+        template <typename Network, int Size>
+        struct NetworkStep<Network, Size, Size>
+        {
+            template <typename T, typename Compare>
+            static void apply(T *, Compare &)
+            {
+            }
+        };
+
+        template <typename T, typename Compare>
+        inline void insertionSort(T *first, T *last, Compare &compare)
+        {
+            if (first == last)
+            {
+                return;
+            }
+            for (T *current = first + 1; current != last; ++current)
+            {
+                if (compare(*current, current[-1]))
+                {
+                    T value = std::move(*current);
+                    T *hole = current;
+                    do
+                    {
+                        *hole = std::move(hole[-1]);
+                        --hole;
+                    } while (hole != first && compare(value, hole[-1]));
+                    *hole = std::move(value);
+                }
+            }
+        }
+
+        /// @brief Insertion sort that relies on the element before `first` being no greater than any in the range.
+        template <typename T, typename Compare>
+        inline void unguardedInsertionSort(T *first, T *last, Compare &compare)
+        {
+            if (first == last)
+            {
+                return;
+            }
+            for (T *current = first + 1; current != last; ++current)
+            {
+                if (compare(*current, current[-1]))
+                {
+                    T value = std::move(*current);
+                    T *hole = current;
+                    do
+                    {
+                        *hole = std::move(hole[-1]);
+                        --hole;
+                    } while (compare(value, hole[-1]));
+                    *hole = std::move(value);
+                }
+            }
+        }
+
+        /// @brief Insertion sort that gives up once it has moved `PartialInsertionSortLimit` elements.
+        /// @return True if the range is now sorted.
+        template <typename T, typename Compare>
+        inline bool partialInsertionSort(T *first, T *last, Compare &compare)
+        {
+            if (first == last)
+            {
+                return true;
+            }
+            int moved = 0;
+            for (T *current = first + 1; current != last; ++current)
+            {
+                if (compare(*current, current[-1]))
+                {
+                    T value = std::move(*current);
+                    T *hole = current;
+                    do
+                    {
+                        *hole = std::move(hole[-1]);
+                        --hole;
+                    } while (hole != first && compare(value, hole[-1]));
+                    *hole = std::move(value);
+                    moved += static_cast<int>(current - hole);
+                }
+                if (moved > PartialInsertionSortLimit)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template <typename T, typename Compare>
+        inline void siftDown(T *heap, int size, int root, Compare &compare)
+        {
+            T value = std::move(heap[root]);
+            while (true)
+            {
+                int child = 2 * root + 1;
+                if (child >= size)
+                {
+                    break;
+                }
+                if (child + 1 < size && compare(heap[child], heap[child + 1]))
+                {
+                    ++child;
+                }
+                if (!compare(value, heap[child]))
+                {
+                    break;
+                }
+                heap[root] = std::move(heap[child]);
+                root = child;
+            }
+            heap[root] = std::move(value);
+        }
+
+        template <typename T, typename Compare>
+        inline void heapSort(T *first, T *last, Compare &compare)
+        {
+            int size = static_cast<int>(last - first);
+            for (int root = size / 2 - 1; root >= 0; --root)
+            {
+                siftDown(first, size, root, compare);
+            }
+            for (int end = size - 1; end > 0; --end)
+            {
+                std::swap(first[0], first[end]);
+                siftDown(first, end, 0, compare);
+            }
+        }
+
+        template <typename T, typename Compare>
+        inline void sort2(T *a, T *b, Compare &compare)
+        {
+            if (compare(*b, *a))
+            {
+                std::swap(*a, *b);
+            }
+        }
+
+        template <typename T, typename Compare>
+        inline void sort3(T *a, T *b, T *c, Compare &compare)
+        {
+            sort2(a, b, compare);
+            sort2(b, c, compare);
+            sort2(a, b, compare);
+        }
+
+        /// @brief Moves the pivot to `first`: the median of three elements, or of three medians for large ranges.
+        /// @details Also leaves an element no less than the pivot at the end, which bounds the partition scans.
+        template <typename T, typename Compare>
+        inline void choosePivot(T *first, T *last, Compare &compare)
+        {
+            int size = static_cast<int>(last - first);
+            int half = size / 2;
+            if (size > NintherThreshold)
+            {
+                sort3(first, first + half, last - 1, compare);
+                sort3(first + 1, first + (half - 1), last - 2, compare);
+                sort3(first + 2, first + (half + 1), last - 3, compare);
+                sort3(first + (half - 1), first + half, first + (half + 1), compare);
+                std::swap(*first, first[half]);
+            }
+            else
+            {
+                sort3(first + half, first, last - 1, compare);
+            }
+        }
+
+        template <typename T>
+        struct PartitionResult
+        {
+            /// The final position of the pivot.
+            T *pivot;
+            /// True if no elements had to be swapped.
+            bool alreadyPartitioned;
+        };
+
+        /// @brief Partitions around the pivot at `first`, putting elements equal to it on the right.
+        template <typename T, typename Compare>
+        inline PartitionResult<T> partitionRight(T *first, T *last, Compare &compare)
+        {
+            T pivot = std::move(*first);
+            T *left = first;
+            T *right = last;
+            while (compare(*++left, pivot))
+            {
+            }
+            if (left - 1 == first)
+            {
+                while (left < right && !compare(*--right, pivot))
+                {
+                }
+            }
+            else
+            {
+                while (!compare(*--right, pivot))
+                {
+                }
+            }
+
+            bool alreadyPartitioned = left >= right;
+            while (left < right)
+            {
+                std::swap(*left, *right);
+                while (compare(*++left, pivot))
+                {
+                }
+                while (!compare(*--right, pivot))
+                {
+                }
+            }
+
+            T *position = left - 1;
+            *first = std::move(*position);
+            *position = std::move(pivot);
+            PartitionResult<T> result = {position, alreadyPartitioned};
+            return result;
+        }
+
+        /// @brief Swaps the elements at matching offsets from the two ends, as a cycle of moves unless the counts match.
+        template <typename T>
+        inline void swapOffsets(T *left, T *right, const unsigned char *leftOffsets, const unsigned char *rightOffsets,
+                                int count, bool useSwaps)
+        {
+            if (useSwaps)
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    std::swap(left[leftOffsets[i]], *(right - rightOffsets[i]));
+                }
+            }
+            else if (count > 0)
+            {
+                T *l = left + leftOffsets[0];
+                T *r = right - rightOffsets[0];
+                T value = std::move(*l);
+                *l = std::move(*r);
+                for (int i = 1; i < count; ++i)
+                {
+                    l = left + leftOffsets[i];
+                    *r = std::move(*l);
+                    r = right - rightOffsets[i];
+                    *l = std::move(*r);
+                }
+                *r = std::move(value);
+            }
+        }
+
+        /// @brief `partitionRight` that first compares a block of elements from each end, recording the offsets of the
+        ///        misplaced ones, then swaps them. The comparison loops have no data-dependent branches.
+        template <typename T, typename Compare>
+        inline PartitionResult<T> partitionRightBlocks(T *first, T *last, Compare &compare)
+        {
+            T pivot = std::move(*first);
+            T *left = first;
+            T *right = last;
+            while (compare(*++left, pivot))
+            {
+            }
+            if (left - 1 == first)
+            {
+                while (left < right && !compare(*--right, pivot))
+                {
+                }
+            }
+            else
+            {
+                while (!compare(*--right, pivot))
+                {
+                }
+            }
+
+            bool alreadyPartitioned = left >= right;
+            if (!alreadyPartitioned)
+            {
+                std::swap(*left, *right);
+                ++left;
+
+                unsigned char leftOffsets[PartitionBlockSize];
+                unsigned char rightOffsets[PartitionBlockSize];
+                T *leftBase = left;
+                T *rightBase = right;
+                int leftCount = 0;
+                int rightCount = 0;
+                int leftStart = 0;
+                int rightStart = 0;
+                while (left < right)
+                {
+                    // Refill whichever side ran out, splitting the unknown elements if both did
+                    int unknown = static_cast<int>(right - left);
+                    int leftSplit = leftCount == 0 ? (rightCount == 0 ? unknown / 2 : unknown) : 0;
+                    int rightSplit = rightCount == 0 ? unknown - leftSplit : 0;
+                    if (leftSplit > PartitionBlockSize)
+                    {
+                        leftSplit = PartitionBlockSize;
+                    }
+                    if (rightSplit > PartitionBlockSize)
+                    {
+                        rightSplit = PartitionBlockSize;
+                    }
+                    for (int i = 0; i < leftSplit; ++i)
+                    {
+                        leftOffsets[leftCount] = static_cast<unsigned char>(i);
+                        leftCount += !compare(*left, pivot);
+                        ++left;
+                    }
+                    for (int i = 0; i < rightSplit; ++i)
+                    {
+                        rightOffsets[rightCount] = static_cast<unsigned char>(i + 1);
+                        rightCount += compare(*--right, pivot);
+                    }
+
+                    int count = leftCount < rightCount ? leftCount : rightCount;
+                    swapOffsets(leftBase, rightBase, leftOffsets + leftStart, rightOffsets + rightStart, count,
+                                leftCount == rightCount);
+                    leftCount -= count;
+                    rightCount -= count;
+                    leftStart += count;
+                    rightStart += count;
+                    if (leftCount == 0)
+                    {
+                        leftStart = 0;
+                        leftBase = left;
+                    }
+                    if (rightCount == 0)
+                    {
+                        rightStart = 0;
+                        rightBase = right;
+                    }
+                }
+
+                // One side may still have misplaced elements; move them to the boundary
+                if (leftCount != 0)
+                {
+                    while (leftCount-- != 0)
+                    {
+                        std::swap(leftBase[leftOffsets[leftStart + leftCount]], *--right);
+                    }
+                    left = right;
+                }
+                if (rightCount != 0)
+                {
+                    while (rightCount-- != 0)
+                    {
+                        std::swap(*(rightBase - rightOffsets[rightStart + rightCount]), *left);
+                        ++left;
+                    }
+                }
+            }
+
+            T *position = left - 1;
+            *first = std::move(*position);
+            *position = std::move(pivot);
+            PartitionResult<T> result = {position, alreadyPartitioned};
+            return result;
+        }
+
+        template <bool Blocks>
+        struct Partitioner
+        {
+            template <typename T, typename Compare>
+            static PartitionResult<T> partition(T *first, T *last, Compare &compare)
+            {
+                return partitionRight(first, last, compare);
+            }
+        };
+
+        template <>
+        struct Partitioner<true>
+        {
+            template <typename T, typename Compare>
+            static PartitionResult<T> partition(T *first, T *last, Compare &compare)
+            {
+                return partitionRightBlocks(first, last, compare);
+            }
+        };
+
+        /// @brief Partitions around the pivot at `first` with the fastest method for the element and comparison types.
+        template <typename T, typename Compare>
+        inline PartitionResult<T> partitionPivot(T *first, T *last, Compare &compare)
+        {
+            return Partitioner<IsBranchlessCompare<T, Compare>::value>::partition(first, last, compare);
+        }
+
+        /// @brief Partitions around the pivot at `first`, putting elements equal to it on the left.
+        /// @details Used when the pivot equals the element before the range, so everything on the left ends up equal and
+        ///          needs no further sorting. This keeps ranges with many duplicates linear.
+        template <typename T, typename Compare>
+        inline T *partitionLeft(T *first, T *last, Compare &compare)
+        {
+            T pivot = std::move(*first);
+            T *left = first;
+            T *right = last;
+            while (compare(pivot, *--right))
+            {
+            }
+            if (right + 1 == last)
+            {
+                while (left < right && !compare(pivot, *++left))
+                {
+                }
+            }
+            else
+            {
+                while (!compare(pivot, *++left))
+                {
+                }
+            }
+
+            while (left < right)
+            {
+                std::swap(*left, *right);
+                while (compare(pivot, *--right))
+                {
+                }
+                while (!compare(pivot, *++left))
+                {
+                }
+            }
+
+            *first = std::move(*right);
+            *right = std::move(pivot);
+            return right;
+        }
+
+        /// @brief Swaps a few elements of both sides of an unbalanced partition, so that the next pivots differ.
+        template <typename T>
+        inline void breakPatterns(T *first, T *pivot, T *last)
+        {
+            int leftSize = static_cast<int>(pivot - first);
+            int rightSize = static_cast<int>(last - (pivot + 1));
+            if (leftSize >= InsertionSortThreshold)
+            {
+                std::swap(first[0], first[leftSize / 4]);
+                std::swap(pivot[-1], pivot[-(leftSize / 4)]);
+                if (leftSize > NintherThreshold)
+                {
+                    std::swap(first[1], first[leftSize / 4 + 1]);
+                    std::swap(first[2], first[leftSize / 4 + 2]);
+                    std::swap(pivot[-2], pivot[-(leftSize / 4 + 1)]);
+                    std::swap(pivot[-3], pivot[-(leftSize / 4 + 2)]);
+                }
+            }
+            if (rightSize >= InsertionSortThreshold)
+            {
+                std::swap(pivot[1], pivot[1 + rightSize / 4]);
+                std::swap(last[-1], last[-(rightSize / 4)]);
+                if (rightSize > NintherThreshold)
+                {
+                    std::swap(pivot[2], pivot[2 + rightSize / 4]);
+                    std::swap(pivot[3], pivot[3 + rightSize / 4]);
+                    std::swap(last[-2], last[-(1 + rightSize / 4)]);
+                    std::swap(last[-3], last[-(2 + rightSize / 4)]);
+                }
+            }
+        }
+
+        inline int floorLog2(int value)
+        {
+            int log = 0;
+            while (value >>= 1)
+            {
+                ++log;
+            }
+            return log;
+        }
+
+        /// @brief Pattern-defeating quicksort.
+        /// @details Quicksort with median-of-three pivots that detects sorted and equal runs, and falls back to heap sort
+        ///          after `badAllowed` unbalanced partitions, so the worst case is O(n log n).
+        /// @param leftmost False if the element before `first` is no greater than any element in the range.
+        template <typename T, typename Compare>
+        inline void pdqsort(T *first, T *last, Compare &compare, int badAllowed, bool leftmost)
+        {
+            while (true)
+            {
+                int size = static_cast<int>(last - first);
+                if (size < InsertionSortThreshold)
+                {
+                    if (leftmost)
+                    {
+                        insertionSort(first, last, compare);
+                    }
+                    else
+                    {
+                        unguardedInsertionSort(first, last, compare);
+                    }
+                    return;
+                }
+
+                choosePivot(first, last, compare);
+                if (!leftmost && !compare(first[-1], *first))
+                {
+                    first = partitionLeft(first, last, compare) + 1;
+                    continue;
+                }
+
+                PartitionResult<T> result = partitionPivot(first, last, compare);
+                T *pivot = result.pivot;
+                int leftSize = static_cast<int>(pivot - first);
+                int rightSize = static_cast<int>(last - (pivot + 1));
+                if (leftSize < size / 8 || rightSize < size / 8)
+                {
+                    if (--badAllowed == 0)
+                    {
+                        heapSort(first, last, compare);
+                        return;
+                    }
+                    breakPatterns(first, pivot, last);
+                }
+                else if (result.alreadyPartitioned && partialInsertionSort(first, pivot, compare) &&
+                         partialInsertionSort(pivot + 1, last, compare))
+                {
+                    return;
+                }
+
+                pdqsort(first, pivot, compare, badAllowed, leftmost);
+                first = pivot + 1;
+                leftmost = false;
+            }
+        }
+
+        template <bool Network>
+        struct SequentialSort
+        {
+            template <int N, typename T, typename Compare>
+            static void sort(T *items, Compare &compare)
+            {
+                pdqsort(items, items + N, compare, floorLog2(N), true);
+            }
+        };
+
+        template <>
+        struct SequentialSort<true>
+        {
+            template <int N, typename T, typename Compare>
+            static void sort(T *items, Compare &compare)
+            {
+                NetworkStep<NetworkTable<N, 0, N>>::apply(items, compare);
+            }
+        };
+
+        /// @brief Pattern-defeating quicksort that sorts the left side of each large partition in a spawned task.
+        template <unsigned int Workers, unsigned int Capacity, typename T, typename Compare>
+        void parallelPdqsort(Scheduler<Workers, Capacity> &scheduler, T *first, T *last, Compare &compare,
+                             int badAllowed, bool leftmost)
+        {
+            while (true)
+            {
+                int size = static_cast<int>(last - first);
+                if (size <= ParallelSortGrain)
+                {
+                    pdqsort(first, last, compare, badAllowed, leftmost);
+                    return;
+                }
+
+                choosePivot(first, last, compare);
+                if (!leftmost && !compare(first[-1], *first))
+                {
+                    first = partitionLeft(first, last, compare) + 1;
+                    continue;
+                }
+
+                PartitionResult<T> result = partitionPivot(first, last, compare);
+                T *pivot = result.pivot;
+                int leftSize = static_cast<int>(pivot - first);
+                int rightSize = static_cast<int>(last - (pivot + 1));
+                if (leftSize < size / 8 || rightSize < size / 8)
+                {
+                    if (--badAllowed == 0)
+                    {
+                        heapSort(first, last, compare);
+                        return;
+                    }
+                    breakPatterns(first, pivot, last);
+                }
+                else if (result.alreadyPartitioned && partialInsertionSort(first, pivot, compare) &&
+                         partialInsertionSort(pivot + 1, last, compare))
+                {
+                    return;
+                }
+
+                auto sortLeft = [&scheduler, first, pivot, &compare, badAllowed, leftmost]()
+                {
+                    parallelPdqsort(scheduler, first, pivot, compare, badAllowed, leftmost);
+                };
+                auto task = makeTask(sortLeft);
+                if (!scheduler.spawn(task))
+                {
+                    sortLeft();
+                }
+                parallelPdqsort(scheduler, pivot + 1, last, compare, badAllowed, false);
+                scheduler.wait(task);
+                return;
+            }
+        }
+
+        template <typename T, typename Compare>
+        inline void introSelect(T *first, T *nth, T *last, Compare &compare)
+        {
+            int badAllowed = floorLog2(static_cast<int>(last - first));
+            bool leftmost = true;
+            while (last - first >= InsertionSortThreshold)
+            {
+                choosePivot(first, last, compare);
+                if (!leftmost && !compare(first[-1], *first))
+                {
+                    // Everything up to the returned position equals the element before the range
+                    T *equal = partitionLeft(first, last, compare);
+                    if (nth <= equal)
+                    {
+                        return;
+                    }
+                    first = equal + 1;
+                    continue;
+                }
+
+                PartitionResult<T> result = partitionPivot(first, last, compare);
+                T *pivot = result.pivot;
+                int size = static_cast<int>(last - first);
+                int leftSize = static_cast<int>(pivot - first);
+                int rightSize = static_cast<int>(last - (pivot + 1));
+                if (leftSize < size / 8 || rightSize < size / 8)
+                {
+                    if (--badAllowed == 0)
+                    {
+                        heapSort(first, last, compare);
+                        return;
+                    }
+                    breakPatterns(first, pivot, last);
+                }
+
+                if (nth == pivot)
+                {
+                    return;
+                }
+                if (nth < pivot)
+                {
+                    last = pivot;
+                }
+                else
+                {
+                    first = pivot + 1;
+                    leftmost = false;
+                }
+            }
+            insertionSort(first, last, compare);
+        }
+
+        /// @brief Merges two sorted ranges into `out`, taking from the left range first on ties.
+        template <typename T, typename Compare>
+        inline void merge(T *left, T *leftEnd, T *right, T *rightEnd, T *out, Compare &compare)
+        {
+            while (left != leftEnd && right != rightEnd)
+            {
+                if (compare(*right, *left))
+                {
+                    *out++ = std::move(*right++);
+                }
+                else
+                {
+                    *out++ = std::move(*left++);
+                }
+            }
+            while (left != leftEnd)
+            {
+                *out++ = std::move(*left++);
+            }
+            while (right != rightEnd)
+            {
+                *out++ = std::move(*right++);
+            }
+        }
+
+        /// @brief Bottom-up merge sort of `size` elements, using `scratch` for as many elements.
+        template <typename T, typename Compare>
+        inline void mergeSort(T *items, T *scratch, int size, Compare &compare)
+        {
+            for (int start = 0; start < size; start += MergeSortRun)
+            {
+                insertionSort(items + start, items + (size - start < MergeSortRun ? size : start + MergeSortRun), compare);
+            }
+
+            T *from = items;
+            T *to = scratch;
+            for (int width = MergeSortRun; width < size; width *= 2)
+            {
+                for (int start = 0; start < size; start += 2 * width)
+                {
+                    int middle = size - start < width ? size : start + width;
+                    int end = size - start < 2 * width ? size : start + 2 * width;
+                    merge(from + start, from + middle, from + middle, from + end, to + start, compare);
+                }
+                std::swap(from, to);
+            }
+            if (from != items)
+            {
+                for (int i = 0; i < size; ++i)
+                {
+                    items[i] = std::move(from[i]);
+                }
+            }
+        }
+
+        /// @brief Merges two sorted ranges into `out`, splitting large merges into independent halves run in parallel.
+        template <unsigned int Workers, unsigned int Capacity, typename T, typename Compare>
+        void parallelMerge(Scheduler<Workers, Capacity> &scheduler, T *left, T *leftEnd, T *right, T *rightEnd, T *out,
+                           Compare &compare)
+        {
+            int leftSize = static_cast<int>(leftEnd - left);
+            int rightSize = static_cast<int>(rightEnd - right);
+            if (leftSize + rightSize <= ParallelSortGrain)
+            {
+                merge(left, leftEnd, right, rightEnd, out, compare);
+                return;
+            }
+
+            // Split the larger range in the middle and the other at the matching position, keeping ties left-first
+            T *leftMiddle;
+            T *rightMiddle;
+            if (leftSize >= rightSize)
+            {
+                leftMiddle = left + leftSize / 2;
+                rightMiddle = right;
+                for (int count = rightSize; count > 0;)
+                {
+                    int step = count / 2;
+                    if (compare(rightMiddle[step], *leftMiddle))
+                    {
+                        rightMiddle += step + 1;
+                        count -= step + 1;
+                    }
+                    else
+                    {
+                        count = step;
+                    }
+                }
+            }
+            else
+            {
+                rightMiddle = right + rightSize / 2;
+                leftMiddle = left;
+                for (int count = leftSize; count > 0;)
+                {
+                    int step = count / 2;
+                    if (!compare(*rightMiddle, leftMiddle[step]))
+                    {
+                        leftMiddle += step + 1;
+                        count -= step + 1;
+                    }
+                    else
+                    {
+                        count = step;
+                    }
+                }
+            }
+
+            T *outMiddle = out + (leftMiddle - left) + (rightMiddle - right);
+            auto mergeLow = [&scheduler, left, leftMiddle, right, rightMiddle, out, &compare]()
+            {
+                parallelMerge(scheduler, left, leftMiddle, right, rightMiddle, out, compare);
+            };
+            auto task = makeTask(mergeLow);
+            if (!scheduler.spawn(task))
+            {
+                mergeLow();
+            }
+            parallelMerge(scheduler, leftMiddle, leftEnd, rightMiddle, rightEnd, outMiddle, compare);
+            scheduler.wait(task);
+        }
+
+        /// @brief Parallel merge sort. Leaves the result in `scratch` if `intoScratch` is set, otherwise in `items`.
+        template <unsigned int Workers, unsigned int Capacity, typename T, typename Compare>
+        void parallelMergeSort(Scheduler<Workers, Capacity> &scheduler, T *items, T *scratch, int size, Compare &compare,
+                               bool intoScratch)
+        {
+            if (size <= ParallelSortGrain)
+            {
+                mergeSort(items, scratch, size, compare);
+                if (intoScratch)
+                {
+                    for (int i = 0; i < size; ++i)
+                    {
+                        scratch[i] = std::move(items[i]);
+                    }
+                }
+                return;
+            }
+
+            // Sort the halves into the other buffer, so the final merge lands where it should without a copy
+            int half = size / 2;
+            auto sortLow = [&scheduler, items, scratch, half, &compare, intoScratch]()
+            {
+                parallelMergeSort(scheduler, items, scratch, half, compare, !intoScratch);
+            };
+            auto task = makeTask(sortLow);
+            if (!scheduler.spawn(task))
+            {
+                sortLow();
+            }
+            parallelMergeSort(scheduler, items + half, scratch + half, size - half, compare, !intoScratch);
+            scheduler.wait(task);
+
+            T *from = intoScratch ? items : scratch;
+            T *to = intoScratch ? scratch : items;
+            parallelMerge(scheduler, from, from + half, from + half, from + size, to, compare);
+        }
+
+        template <int Size>
+        struct RadixBits;
+
+        template <>
+        struct RadixBits<1>
+        {
+            typedef unsigned char type;
+        };
+
+        template <>
+        struct RadixBits<2>
+        {
+            typedef unsigned short type;
+        };
+
+        template <>
+        struct RadixBits<4>
+        {
+            typedef unsigned int type;
+        };
+
+        template <>
+        struct RadixBits<8>
+        {
+            typedef unsigned long long type;
+        };
+
+        /// @brief Maps keys to unsigned integers with the same order, so they can be sorted byte by byte.
+        template <typename Key, bool Floating = std::is_floating_point<Key>::value, bool Signed = std::is_signed<Key>::value>
+        struct RadixKey
+        {
+            typedef typename RadixBits<sizeof(Key)>::type Bits;
+
+            static Bits encode(Key key)
+            {
+                return static_cast<Bits>(key);
+            }
+        };
+
+        template <typename Key>
+        struct RadixKey<Key, false, true>
+        {
+            typedef typename RadixBits<sizeof(Key)>::type Bits;
+
+            static Bits encode(Key key)
+            {
+                // Flipping the sign bit moves negative numbers below positive ones
+                return static_cast<Bits>(static_cast<Bits>(key) ^ (static_cast<Bits>(1) << (sizeof(Key) * 8 - 1)));
+            }
+        };
+
+        template <typename Key>
+        struct RadixKey<Key, true, true>
+        {
+            typedef typename RadixBits<sizeof(Key)>::type Bits;
+
+            static Bits encode(Key key)
+            {
+                // Negative floats order backwards by their bits, so flip all of them; flip only the sign of the rest
+                Bits bits;
+                std::memcpy(&bits, &key, sizeof(Key));
+                Bits sign = static_cast<Bits>(1) << (sizeof(Key) * 8 - 1);
+                return (bits & sign) != 0 ? static_cast<Bits>(~bits) : static_cast<Bits>(bits | sign);
+            }
+        };
+
+        template <typename T>
+        struct IdentityKey
+        {
+            T operator()(const T &item) const
+            {
+                return item;
+            }
+        };
+    }
+
+    /// @brief Sorts a small Iterable with a sorting network generated at compile time.
+    /// @details The network is a fixed sequence of compare-exchanges that only depends on `N`, unrolled into
+    ///          straight-line code, and each compare-exchange is a branch-free minimum and maximum. The running time does
+    ///          not depend on the data, and there are no branch mispredictions. Up to 16 elements the network is the best
+    ///          known one (proven optimal up to 12), checked at compile time to sort every input. From 17 to 32 elements it
+    ///          is Batcher's odd-even merge network.
+    /// @tparam Compare A strict weak ordering taking `(const T&, const T&)`.
+    /// @param items The elements to sort. At most 32.
+    /// @param compare The ordering, `Less<T>` by default.
+    template <typename T, int N, typename Compare = Less<T>>
+    inline void sortNetwork(Iterable<T, N> &items, Compare compare = Compare())
+    {
+        static_assert(N <= 32, "Sorting networks are only generated for up to 32 elements");
+        detail::NetworkStep<detail::NetworkTable<N, 0, N>>::apply(items.begin(), compare);
+    }
+
+    /// @brief Returns the median of a small Iterable, e.g. for a median filter.
+    /// @details Copies the elements and runs only the compare-exchanges of the sorting network that the middle output
+    ///          depends on, e.g. 20 instead of 25 for 9 elements.
+    /// @tparam T The type of elements, possibly const, e.g. for a read-only view. Must be default constructible.
+    /// @tparam Compare A strict weak ordering taking `(const T&, const T&)`.
+    /// @param items The elements. At most 32. They are not changed.
+    /// @param compare The ordering, `Less<T>` by default.
+    /// @return A copy of the middle element in sorted order. For even `N`, the upper of the two middle elements.
+    template <typename T, int N, typename Compare = Less<typename std::remove_cv<T>::type>>
+    inline typename std::remove_cv<T>::type median(const Iterable<T, N> &items, Compare compare = Compare())
+    {
+        static_assert(N <= 32, "Sorting networks are only generated for up to 32 elements");
+        typename std::remove_cv<T>::type values[N];
+        for (int i = 0; i < N; ++i)
+        {
+            values[i] = items.begin()[i];
+        }
+        detail::NetworkStep<detail::NetworkTable<N, N / 2, N / 2 + 1>>::apply(values, compare);
+        return values[N / 2];
+    }
+
+    /// @brief Moves the first `K` elements in sorted order of a small Iterable to its front, sorted.
+    /// @details Runs only the compare-exchanges of the sorting network that the first `K` outputs depend on. The other
+    ///          elements are left after them in no particular order. Use `Greater<T>` to get the largest elements.
+    /// @tparam K The number of elements to select.
+    /// @tparam Compare A strict weak ordering taking `(const T&, const T&)`.
+    /// @param items The elements. At most 32.
+    /// @param compare The ordering, `Less<T>` by default.
+    template <int K, typename T, int N, typename Compare = Less<T>>
+    inline void topK(Iterable<T, N> &items, Compare compare = Compare())
+    {
+        static_assert(K >= 0 && K <= N, "K must be between 0 and N");
+        static_assert(N <= 32, "Sorting networks are only generated for up to 32 elements");
+        detail::NetworkStep<detail::NetworkTable<N, 0, K>>::apply(items.begin(), compare);
+    }
+
+    /// @brief Sorts an Iterable in place. The order of equal elements is not kept.
+    /// @details The algorithm is chosen by `N`: up to 16 elements use a sorting network, which does not branch on the
+    ///          data, and larger arrays use pattern-defeating quicksort, which is O(n log n) in the worst case and linear
+    ///          on sorted, reversed and all-equal input.
+    /// @tparam Compare A strict weak ordering taking `(const T&, const T&)`.
+    /// @param items The elements to sort.
+    /// @param compare The ordering, `Less<T>` by default.
+    template <typename T, int N, typename Compare = Less<T>>
+    inline void sort(Iterable<T, N> &items, Compare compare = Compare())
+    {
+        detail::SequentialSort<(N <= detail::NetworkSortMaxSize)>::template sort<N>(items.begin(), compare);
+    }
+
+    /// @brief Sorts an Iterable in place, using the workers of a Scheduler. The order of equal elements is not kept.
+    /// @details Arrays of up to 32768 elements are sorted on the calling thread, as by `sort(items, compare)`. Larger ones
+    ///          are partitioned as by pattern-defeating quicksort, and the two sides of each partition are sorted in parallel.
+    ///          The calling thread takes part in the work.
+    /// @tparam Compare A strict weak ordering taking `(const T&, const T&)`. It is called from several threads at once.
+    /// @param items The elements to sort.
+    /// @param scheduler The Scheduler whose workers help with the sort.
+    /// @param compare The ordering, `Less<T>` by default.
+    template <typename T, int N, unsigned int Workers, unsigned int Capacity, typename Compare = Less<T>>
+    inline void sort(Iterable<T, N> &items, Scheduler<Workers, Capacity> &scheduler, Compare compare = Compare())
+    {
+        if (N <= 2 * detail::ParallelSortGrain)
+        {
+            sort(items, compare);
+        }
+        else
+        {
+            detail::parallelPdqsort(scheduler, items.begin(), items.end(), compare, detail::floorLog2(N), true);
+        }
+    }
+
+    /// @brief Sorts an Iterable in place, keeping the order of equal elements.
+    /// @details Merge sort of insertion-sorted runs. O(n log n) in all cases.
+    /// @tparam Compare A strict weak ordering taking `(const T&, const T&)`.
+    /// @param items The elements to sort.
+    /// @param scratch Space for `N` elements, used during the sort. Its contents afterwards are unspecified.
+    /// @param compare The ordering, `Less<T>` by default.
+    template <typename T, int N, typename Compare = Less<T>>
+    inline void stableSort(Iterable<T, N> &items, Iterable<T, N> &scratch, Compare compare = Compare())
+    {
+        detail::mergeSort(items.begin(), scratch.begin(), N, compare);
+    }
+
+    /// @brief Sorts an Iterable in place, keeping the order of equal elements, using the workers of a Scheduler.
+    /// @details Arrays of up to 32768 elements are sorted on the calling thread. Larger ones are merge sorted with both
+    ///          halves sorted in parallel and each merge split into independent parts, so the merges are parallel too.
+    /// @tparam Compare A strict weak ordering taking `(const T&, const T&)`. It is called from several threads at once.
+    /// @param items The elements to sort.
+    /// @param scratch Space for `N` elements, used during the sort. Its contents afterwards are unspecified.
+    /// @param scheduler The Scheduler whose workers help with the sort.
+    /// @param compare The ordering, `Less<T>` by default.
+    template <typename T, int N, unsigned int Workers, unsigned int Capacity, typename Compare = Less<T>>
+    inline void stableSort(Iterable<T, N> &items, Iterable<T, N> &scratch, Scheduler<Workers, Capacity> &scheduler,
+                           Compare compare = Compare())
+    {
+        if (N <= 2 * detail::ParallelSortGrain)
+        {
+            stableSort(items, scratch, compare);
+        }
+        else
+        {
+            detail::parallelMergeSort(scheduler, items.begin(), scratch.begin(), N, compare, false);
+        }
+    }
+
+    /// @brief Sorts an Iterable in place by integer or floating-point keys, keeping the order of equal keys.
+    /// @details Least-significant-digit radix sort, one pass per byte of the key. Passes where all keys share the same
+    ///          byte are skipped. Runs in O(n) and does not compare elements, so it beats `sort` for large arrays of
+    ///          numeric keys. Floats are ordered as by `<`, with -0.0 before 0.0, and NaNs with the sign bit set before
+    ///          all other values and the rest after them.
+    /// @tparam KeyFunc A callable taking `(const T&)` and returning an integer or floating-point key.
+    /// @param items The elements to sort.
+    /// @param scratch Space for `N` elements, used during the sort. Its contents afterwards are unspecified.
+    /// @param key Returns the key to sort each element by. Called several times per element.
+    template <typename T, int N, typename KeyFunc>
+    inline void radixSort(Iterable<T, N> &items, Iterable<T, N> &scratch, KeyFunc key)
+    {
+        typedef typename std::decay<decltype(key(*items.begin()))>::type Key;
+        static_assert(std::is_arithmetic<Key>::value, "Radix sort keys must be integers or floating-point numbers");
+        typedef detail::RadixKey<Key> Encoding;
+        typedef typename Encoding::Bits Bits;
+        const int Digits = static_cast<int>(sizeof(Bits));
+
+        int counts[sizeof(Bits)][256] = {};
+        for (const T &item : items)
+        {
+            Bits bits = Encoding::encode(key(item));
+            for (int digit = 0; digit < Digits; ++digit)
+            {
+                ++counts[digit][(bits >> (8 * digit)) & 0xFF];
+            }
+        }
+
+        T *from = items.begin();
+        T *to = scratch.begin();
+        for (int digit = 0; digit < Digits; ++digit)
+        {
+            int shift = 8 * digit;
+            if (counts[digit][(Encoding::encode(key(from[0])) >> shift) & 0xFF] == N)
+            {
+                continue;
+            }
+
+            int offsets[256];
+            int offset = 0;
+            for (int byte = 0; byte < 256; ++byte)
+            {
+                offsets[byte] = offset;
+                offset += counts[digit][byte];
+            }
+            for (int i = 0; i < N; ++i)
+            {
+                int byte = static_cast<int>((Encoding::encode(key(from[i])) >> shift) & 0xFF);
+                to[offsets[byte]++] = std::move(from[i]);
+            }
+            std::swap(from, to);
+        }
+
+        if (from != items.begin())
+        {
+            for (int i = 0; i < N; ++i)
+            {
+                items.begin()[i] = std::move(from[i]);
+            }
+        }
+    }
+
+    /// @brief Sorts an Iterable of integers or floating-point numbers in place with radix sort.
+    /// @param items The elements to sort.
+    /// @param scratch Space for `N` elements, used during the sort. Its contents afterwards are unspecified.
+    template <typename T, int N>
+    inline void radixSort(Iterable<T, N> &items, Iterable<T, N> &scratch)
+    {
+        radixSort(items, scratch, detail::IdentityKey<T>());
+    }
+
+    /// @brief Reorders an Iterable so that the elements matching a predicate come first.
+    /// @details The relative order of elements is not kept. Each element is tested once.
+    /// @tparam Predicate A callable taking `(const T&)` and returning `bool`.
+    /// @param items The elements to reorder.
+    /// @param predicate The predicate.
+    /// @return The number of elements matching the predicate, which is also the index of the first one that does not.
+    template <typename T, int N, typename Predicate>
+    inline int partition(Iterable<T, N> &items, Predicate predicate)
+    {
+        T *first = items.begin();
+        T *last = items.end();
+        while (true)
+        {
+            while (first != last && predicate(*first))
+            {
+                ++first;
+            }
+            if (first == last)
+            {
+                break;
+            }
+            do
+            {
+                --last;
+            } while (first != last && !predicate(*last));
+            if (first == last)
+            {
+                break;
+            }
+            std::swap(*first, *last);
+            ++first;
+        }
+        return static_cast<int>(first - items.begin());
+    }
+
+    /// @brief Partially sorts an Iterable so that one element is in its sorted position.
+    /// @details Afterwards, the element at `n` is the one that would be there if the Iterable was sorted, no element
+    ///          before it is greater and no element after it is less. Runs in O(n) on average and O(n log n) at worst.
+    /// @tparam Compare A strict weak ordering taking `(const T&, const T&)`.
+    /// @param items The elements to reorder.
+    /// @param n The index of the element to place, e.g. `N / 2` for the median.
+    /// @param compare The ordering, `Less<T>` by default.
+    /// @return True if successful, false if `n` is out of range.
+    template <typename T, int N, typename Compare = Less<T>>
+    inline bool nthElement(Iterable<T, N> &items, int n, Compare compare = Compare())
+    {
+        if (n < 0 || n >= N)
+        {
+            return false;
+        }
+        detail::introSelect(items.begin(), items.begin() + n, items.end(), compare);
+        return true;
+    }
+
+    /// @brief Checks if an Iterable is sorted.
+    /// @tparam Compare A strict weak ordering taking `(const T&, const T&)`.
+    /// @param items The elements to check.
+    /// @param compare The ordering, `Less<T>` by default.
+    /// @return True if no element is less than the one before it.
+    template <typename T, int N, typename Compare = Less<T>>
+    inline bool isSorted(const Iterable<T, N> &items, Compare compare = Compare())
+    {
+        for (int i = 1; i < N; ++i)
+        {
+            if (compare(items.begin()[i], items.begin()[i - 1]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+#endif // FENZ_SORT_HPP
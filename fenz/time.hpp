@@ -5,56 +5,201 @@
 /// @note This must be defined by the user of the library for `Moment`s to work properly. If not defined, a linker error will be produced.
 long long fenzTimeSource();
 
+/// A function returning a long long representing the number of nanoseconds since an arbitrary start time.
+/// @note This only needs to be defined by the user of the library if Moments finer than a millisecond, such as `NanoMoment`, are used.
+///       If they are used and this is not defined, a linker error will be produced.
+long long fenzTimeSourceNanos();
+
 namespace fenz
 {
+    /// @brief A compile-time rational number, used as the length of one tick of a duration in seconds.
+    /// @tparam Num Numerator.
+    /// @tparam Den Denominator.
+    template <long long Num, long long Den = 1>
+    struct Ratio
+    {
+        static_assert(Num > 0 && Den > 0, "Ratio must be positive");
+
+        static constexpr long long num = Num;
+        static constexpr long long den = Den;
+    };
+
+    template <long long Num, long long Den>
+    constexpr long long Ratio<Num, Den>::num;
+
+    template <long long Num, long long Den>
+    constexpr long long Ratio<Num, Den>::den;
+
+    /// One nanosecond.
+    typedef Ratio<1, 1000000000> Nano;
+    /// One microsecond.
+    typedef Ratio<1, 1000000> Micro;
+    /// One millisecond.
+    typedef Ratio<1, 1000> Milli;
+    /// One second.
+    typedef Ratio<1> Unit;
+
+    namespace detail
+    {
+        constexpr long long gcd(long long a, long long b)
+        {
+            return b == 0 ? a : gcd(b, a % b);
+        }
 
-    /// @brief Represents a time duration.
+        /// @brief The reduced factor to multiply a number of `From` ticks by to get a number of `To` ticks.
+        template <typename From, typename To>
+        struct TickFactor
+        {
+            static constexpr long long rawNum = From::num * To::den;
+            static constexpr long long rawDen = From::den * To::num;
+            static constexpr long long num = rawNum / gcd(rawNum, rawDen);
+            static constexpr long long den = rawDen / gcd(rawNum, rawDen);
+
+            /// True if every number of `From` ticks is a whole number of `To` ticks.
+            static constexpr bool lossless = den == 1;
+        };
+
+        /// @brief Converts a number of `From` ticks to a number of `To` ticks, truncating toward zero.
+        template <typename From, typename To, typename Rep>
+        constexpr Rep convertTicks(Rep ticks)
+        {
+            return TickFactor<From, To>::den == 1   ? static_cast<Rep>(ticks * TickFactor<From, To>::num)
+                   : TickFactor<From, To>::num == 1 ? static_cast<Rep>(ticks / TickFactor<From, To>::den)
+                                                    : static_cast<Rep>(ticks * TickFactor<From, To>::num / TickFactor<From, To>::den);
+        }
+
+        template <bool Condition, typename T = void>
+        struct EnableIf
+        {
+        };
+
+        template <typename T>
+        struct EnableIf<true, T>
+        {
+            typedef T type;
+        };
+
+        /// @brief The longest tick that both `Period1` and `Period2` are a whole number of, so that Durations of either
+        ///        convert to it without loss.
+        template <typename Period1, typename Period2>
+        struct CommonPeriod
+        {
+            typedef Ratio<gcd(Period1::num, Period2::num), Period1::den / gcd(Period1::den, Period2::den) * Period2::den> type;
+        };
+    }
+
+    /// @brief Represents a time duration, counted in ticks of a fixed length.
     /// Provides utility functions for conversion and arithmetic operations.
-    struct Duration
+    /// @tparam Rep The integer type storing the number of ticks.
+    /// @tparam Period The length of one tick in seconds, as a `Ratio`.
+    template <typename Rep, typename Period>
+    struct BasicDuration
     {
-        /// The length of the duration in milliseconds.
-        long long value;
+        /// The integer type storing the number of ticks.
+        typedef Rep rep;
+        /// The length of one tick in seconds.
+        typedef Period period;
+
+        /// The length of the duration in ticks of `Period`.
+        Rep value;
 
-        /// @brief Returns the number of milliseconds this Duration represents.
+        /// @brief Returns the number of ticks this Duration represents.
+        /// @return The number of ticks.
+        inline constexpr Rep count() const
+        {
+            return value;
+        }
+
+        /// @brief Returns the number of whole nanoseconds this Duration represents.
+        /// @return The number of nanoseconds.
+        inline constexpr long long nanos() const
+        {
+            return detail::convertTicks<Period, Nano, long long>(value);
+        }
+
+        /// @brief Returns the number of whole microseconds this Duration represents.
+        /// @return The number of microseconds.
+        inline constexpr long long micros() const
+        {
+            return detail::convertTicks<Period, Micro, long long>(value);
+        }
+
+        /// @brief Returns the number of whole milliseconds this Duration represents.
         /// @return The number of milliseconds.
         inline constexpr long long millis() const
         {
-            return value;
+            return detail::convertTicks<Period, Milli, long long>(value);
         }
 
         /// @brief Returns the number of seconds this Duration represents.
         /// @return The number of seconds as a double.
         inline double seconds() const
         {
-            return static_cast<double>(value) / 1000.0;
+            return static_cast<double>(value) * Period::num / Period::den;
         }
 
     private:
-        /// @brief Constructs a Duration from milliseconds.
-        /// @param ms Number of milliseconds.
-        constexpr Duration(long long ms) : value(ms) {}
+        /// @brief Constructs a Duration from ticks.
+        /// @param ticks Number of ticks.
+        constexpr BasicDuration(Rep ticks) : value(ticks) {}
 
     public:
+        /// @brief Converts a Duration with a different tick length.
+        /// @details Only available when the conversion is lossless, i.e. when every tick of `other` is a whole number
+        ///          of ticks of this Duration. Use `durationCast` for conversions that truncate.
+        /// @param other The Duration to convert.
+        template <typename Rep2, typename Period2,
+                  typename = typename detail::EnableIf<detail::TickFactor<Period2, Period>::lossless>::type>
+        constexpr BasicDuration(const BasicDuration<Rep2, Period2> &other)
+            : value(detail::convertTicks<Period2, Period, Rep>(static_cast<Rep>(other.value)))
+        {
+        }
+
+        /// @brief Creates a Duration from a number of ticks.
+        /// @param ticks Number of ticks.
+        /// @return Duration representing the given ticks.
+        inline static constexpr BasicDuration fromTicks(Rep ticks)
+        {
+            return {ticks};
+        }
+
+        /// @brief Creates a Duration from a number of nanoseconds.
+        /// @param ns Number of nanoseconds.
+        /// @return Duration representing the given nanoseconds, truncated to whole ticks.
+        inline static constexpr BasicDuration fromNanos(long long ns)
+        {
+            return {static_cast<Rep>(detail::convertTicks<Nano, Period, long long>(ns))};
+        }
+
+        /// @brief Creates a Duration from a number of microseconds.
+        /// @param us Number of microseconds.
+        /// @return Duration representing the given microseconds, truncated to whole ticks.
+        inline static constexpr BasicDuration fromMicros(long long us)
+        {
+            return {static_cast<Rep>(detail::convertTicks<Micro, Period, long long>(us))};
+        }
+
         /// @brief Creates a Duration from a number of milliseconds.
         /// @param ms Number of milliseconds.
-        /// @return Duration representing the given milliseconds.
-        inline static constexpr Duration fromMillis(long long ms)
+        /// @return Duration representing the given milliseconds, truncated to whole ticks.
+        inline static constexpr BasicDuration fromMillis(long long ms)
         {
-            return {ms};
+            return {static_cast<Rep>(detail::convertTicks<Milli, Period, long long>(ms))};
         }
+
         /// @brief Creates a Duration from a number of seconds.
         /// @param sec Number of seconds.
-        /// @return Duration representing the given seconds.
-        inline static Duration fromSeconds(double sec)
+        /// @return Duration representing the given seconds, truncated to whole ticks.
+        inline static BasicDuration fromSeconds(double sec)
         {
-            return {static_cast<long long>(sec * 1000)};
+            return {static_cast<Rep>(sec * Period::den / Period::num)};
         }
 
     public:
         /// @brief Adds another Duration to this Duration.
         /// @param duration The Duration to add.
         /// @return Reference to this Duration.
-        inline constexpr Duration &operator+=(const Duration &duration)
+        inline constexpr BasicDuration &operator+=(const BasicDuration &duration)
         {
             value += duration.value;
             return *this;
@@ -63,7 +208,7 @@ namespace fenz
         /// @brief Subtracts another Duration from this Duration.
         /// @param duration The Duration to subtract.
         /// @return Reference to this Duration.
-        inline constexpr Duration &operator-=(const Duration &duration)
+        inline constexpr BasicDuration &operator-=(const BasicDuration &duration)
         {
             value -= duration.value;
             return *this;
@@ -72,50 +217,159 @@ namespace fenz
         /// @brief Multiplies this Duration by a coefficient.
         /// @param coefficient The multiplier.
         /// @return Reference to this Duration.
-        inline constexpr Duration &operator*=(long long coefficient)
+        inline constexpr BasicDuration &operator*=(long long coefficient)
         {
             value *= coefficient;
             return *this;
         }
     };
 
-    /// @brief Represents a point in time.
+    /// @brief The Duration type that two Durations are converted to before they are added, subtracted or compared.
+    /// @details Its tick is the longest that both tick lengths are a whole number of, e.g. nanoseconds for nanoseconds
+    ///          and milliseconds, so the conversion is lossless.
+    template <typename Duration1, typename Duration2>
+    struct CommonDuration;
+
+    template <typename Rep1, typename Period1, typename Rep2, typename Period2>
+    struct CommonDuration<BasicDuration<Rep1, Period1>, BasicDuration<Rep2, Period2>>
+    {
+        typedef BasicDuration<decltype(Rep1() + Rep2()), typename detail::CommonPeriod<Period1, Period2>::type> type;
+    };
+
+    /// A Duration counted in nanoseconds.
+    typedef BasicDuration<long long, Nano> Nanoseconds;
+    /// A Duration counted in microseconds.
+    typedef BasicDuration<long long, Micro> Microseconds;
+    /// A Duration counted in milliseconds.
+    typedef BasicDuration<long long, Milli> Milliseconds;
+    /// The default Duration, counted in milliseconds.
+    typedef Milliseconds Duration;
+
+    /// @brief Converts a Duration to a different tick length, truncating toward zero.
+    /// @tparam ToDuration The Duration type to convert to.
+    /// @param duration The Duration to convert.
+    /// @return The converted Duration.
+    template <typename ToDuration, typename Rep, typename Period>
+    inline constexpr ToDuration durationCast(const BasicDuration<Rep, Period> &duration)
+    {
+        return ToDuration::fromTicks(static_cast<typename ToDuration::rep>(
+            detail::convertTicks<Period, typename ToDuration::period, long long>(static_cast<long long>(duration.value))));
+    }
+
+    /// @brief A source of time that can stand in for the global time source, e.g. to replay recorded time or to run
+    ///        time-driven code faster than real time. See `fenz/clock.hpp` for implementations.
+    class Clock
+    {
+    public:
+        virtual ~Clock() {}
+
+        /// @brief Returns the current time.
+        /// @return Nanoseconds since an arbitrary start time.
+        virtual long long nowNanos() = 0;
+    };
+
+    namespace detail
+    {
+#if defined(FENZ_ENABLE_CLOCK_OVERRIDE)
+        /// @brief Returns the Clock that replaces the global time source on the calling thread, or null if there is none.
+        inline Clock *&clockOverride()
+        {
+            static thread_local Clock *clock = nullptr;
+            return clock;
+        }
+
+        /// @brief Reads the calling thread's Clock override in ticks of `Period`.
+        /// @return True if the thread has an override.
+        template <typename Period>
+        inline bool readClockOverride(long long &ticks)
+        {
+            Clock *clock = clockOverride();
+            if (clock == nullptr)
+            {
+                return false;
+            }
+            ticks = convertTicks<Nano, Period, long long>(clock->nowNanos());
+            return true;
+        }
+#endif
+
+        /// @brief Reads the current time in ticks of `Period` from the matching user-defined time source.
+        /// @details Periods that are whole milliseconds use `fenzTimeSource`, finer periods use `fenzTimeSourceNanos`.
+        ///          If `FENZ_ENABLE_CLOCK_OVERRIDE` is defined, a Clock installed on the calling thread takes precedence.
+        template <typename Period, bool Millis = TickFactor<Period, Milli>::lossless>
+        struct TimeSource
+        {
+            static long long now()
+            {
+#if defined(FENZ_ENABLE_CLOCK_OVERRIDE)
+                long long ticks;
+                if (readClockOverride<Period>(ticks))
+                {
+                    return ticks;
+                }
+#endif
+                return convertTicks<Milli, Period, long long>(fenzTimeSource());
+            }
+        };
+
+        template <typename Period>
+        struct TimeSource<Period, false>
+        {
+            static long long now()
+            {
+#if defined(FENZ_ENABLE_CLOCK_OVERRIDE)
+                long long ticks;
+                if (readClockOverride<Period>(ticks))
+                {
+                    return ticks;
+                }
+#endif
+                return convertTicks<Nano, Period, long long>(fenzTimeSourceNanos());
+            }
+        };
+    }
+
+    /// @brief Represents a point in time, counted in ticks of a fixed length.
     /// Provides utility functions for time arithmetic and comparison.
-    struct Moment
+    /// @tparam Rep The integer type storing the number of ticks.
+    /// @tparam Period The length of one tick in seconds, as a `Ratio`.
+    template <typename Rep, typename Period>
+    struct BasicMoment
     {
-        /// Time in milliseconds relative to the start time defined in the fenzTimeSource implementation.
-        long long value;
+        /// The integer type storing the number of ticks.
+        typedef Rep rep;
+        /// The length of one tick in seconds.
+        typedef Period period;
+
+        /// Time in ticks of `Period` relative to the start time defined in the time source implementation.
+        Rep value;
 
     private:
-        /// @brief Constructs a Moment from milliseconds.
-        /// @param ms Number of milliseconds.
-        constexpr Moment(long long ms) : value(ms) {}
+        /// @brief Constructs a Moment from ticks.
+        /// @param ticks Number of ticks.
+        constexpr BasicMoment(Rep ticks) : value(ticks) {}
 
     public:
         /// @brief Creates a Moment representing the current time.
         /// @return Moment representing the current time.
-        static constexpr Moment now()
+        static BasicMoment now()
         {
-            return {fenzTimeSource()};
+            return {static_cast<Rep>(detail::TimeSource<Period>::now())};
         }
 
-    private:
-        /// @brief Creates a Moment from a number of milliseconds relative to the start time defined in the fenzTimeSource implementation.
-        /// @param millis Number of milliseconds.
-        /// @return Moment representing the given milliseconds.
-        static constexpr Moment fromMillis(long long millis)
+        /// @brief Creates a Moment from a number of ticks since the start time, such as a `value` stored earlier.
+        /// @param ticks Number of ticks.
+        /// @return Moment representing the given time.
+        inline static constexpr BasicMoment fromTicks(Rep ticks)
         {
-            return {millis};
+            return {ticks};
         }
 
-        friend constexpr Moment operator+(const Moment &m, const Duration &d);
-        friend constexpr Moment operator-(const Moment &m, const Duration &d);
-
     public:
         /// @brief Adds a Duration to this Moment.
         /// @param duration The Duration to add.
         /// @return Reference to this Moment.
-        inline constexpr Moment &operator+=(const Duration &duration)
+        inline constexpr BasicMoment &operator+=(const BasicDuration<Rep, Period> &duration)
         {
             value += duration.value;
             return *this;
@@ -124,73 +378,98 @@ namespace fenz
         /// @brief Subtracts a Duration from this Moment.
         /// @param duration The Duration to subtract.
         /// @return Reference to this Moment.
-        inline constexpr Moment &operator-=(const Duration &duration)
+        inline constexpr BasicMoment &operator-=(const BasicDuration<Rep, Period> &duration)
         {
             value -= duration.value;
             return *this;
         }
     };
 
+    /// A Moment counted in nanoseconds, read from `fenzTimeSourceNanos`.
+    typedef BasicMoment<long long, Nano> NanoMoment;
+    /// A Moment counted in microseconds, read from `fenzTimeSourceNanos`.
+    typedef BasicMoment<long long, Micro> MicroMoment;
+    /// The default Moment, counted in milliseconds and read from `fenzTimeSource`.
+    typedef BasicMoment<long long, Milli> Moment;
+
     /// @brief Returns the Duration between two Moments.
+    /// @details Both Moments must have the same type: Moments of different tick lengths may be read from different
+    ///          time sources, with different start times.
     /// @param lhs The later Moment.
     /// @param rhs The earlier Moment.
     /// @return Duration between the two Moments.
     /// @note This may produce negative durations.
-    inline constexpr Duration operator-(const Moment &lhs, const Moment &rhs)
+    template <typename Rep, typename Period>
+    inline constexpr BasicDuration<Rep, Period> operator-(const BasicMoment<Rep, Period> &lhs, const BasicMoment<Rep, Period> &rhs)
     {
-        return Duration::fromMillis(lhs.value - rhs.value);
+        return BasicDuration<Rep, Period>::fromTicks(lhs.value - rhs.value);
     }
 
     /// @brief Adds a Duration to a Moment, returning a new Moment.
+    /// @details The Duration may have a different tick length, as long as it converts to the Moment's without loss,
+    ///          e.g. milliseconds added to a NanoMoment.
     /// @param m The original Moment.
     /// @param d The Duration to add.
     /// @return New Moment after addition.
-    inline constexpr Moment operator+(const Moment &m, const Duration &d)
+    template <typename Rep, typename Period, typename Rep2, typename Period2,
+              typename = typename detail::EnableIf<detail::TickFactor<Period2, Period>::lossless>::type>
+    inline constexpr BasicMoment<Rep, Period> operator+(const BasicMoment<Rep, Period> &m, const BasicDuration<Rep2, Period2> &d)
     {
-        return Moment::fromMillis(m.value + d.value);
+        return BasicMoment<Rep, Period>::fromTicks(m.value + BasicDuration<Rep, Period>(d).value);
     }
 
     /// @brief Subtracts a Duration from a Moment, returning a new Moment.
+    /// @details The Duration may have a different tick length, as long as it converts to the Moment's without loss.
     /// @param m The original Moment.
     /// @param d The Duration to subtract.
     /// @return New Moment after subtraction.
-    inline constexpr Moment operator-(const Moment &m, const Duration &d)
+    template <typename Rep, typename Period, typename Rep2, typename Period2,
+              typename = typename detail::EnableIf<detail::TickFactor<Period2, Period>::lossless>::type>
+    inline constexpr BasicMoment<Rep, Period> operator-(const BasicMoment<Rep, Period> &m, const BasicDuration<Rep2, Period2> &d)
     {
-        return Moment::fromMillis(m.value - d.value);
+        return BasicMoment<Rep, Period>::fromTicks(m.value - BasicDuration<Rep, Period>(d).value);
     }
 
     /// @brief Adds two Durations, returning a new Duration.
     /// @param lhs First Duration.
     /// @param rhs Second Duration.
-    /// @return Sum of the two Durations.
-    inline constexpr Duration operator+(const Duration &lhs, const Duration &rhs)
+    /// @return Sum of the two Durations, in ticks of their CommonDuration.
+    template <typename Rep1, typename Period1, typename Rep2, typename Period2>
+    inline constexpr typename CommonDuration<BasicDuration<Rep1, Period1>, BasicDuration<Rep2, Period2>>::type
+    operator+(const BasicDuration<Rep1, Period1> &lhs, const BasicDuration<Rep2, Period2> &rhs)
     {
-        return Duration::fromMillis(lhs.value + rhs.value);
+        typedef typename CommonDuration<BasicDuration<Rep1, Period1>, BasicDuration<Rep2, Period2>>::type Common;
+        return Common::fromTicks(Common(lhs).value + Common(rhs).value);
     }
 
     /// @brief Subtracts one Duration from another, returning a new Duration.
     /// @param lhs First Duration.
     /// @param rhs Second Duration.
-    /// @return Difference of the two Durations.
-    inline constexpr Duration operator-(const Duration &lhs, const Duration &rhs)
+    /// @return Difference of the two Durations, in ticks of their CommonDuration.
+    template <typename Rep1, typename Period1, typename Rep2, typename Period2>
+    inline constexpr typename CommonDuration<BasicDuration<Rep1, Period1>, BasicDuration<Rep2, Period2>>::type
+    operator-(const BasicDuration<Rep1, Period1> &lhs, const BasicDuration<Rep2, Period2> &rhs)
     {
-        return Duration::fromMillis(lhs.value - rhs.value);
+        typedef typename CommonDuration<BasicDuration<Rep1, Period1>, BasicDuration<Rep2, Period2>>::type Common;
+        return Common::fromTicks(Common(lhs).value - Common(rhs).value);
     }
 
     /// @brief Multiplies a Duration by a coefficient, returning a new Duration.
     /// @param lhs The Duration.
     /// @param coefficient The multiplier.
     /// @return Product of the Duration and the coefficient.
-    inline constexpr Duration operator*(const Duration &lhs, const long long &coefficient)
+    template <typename Rep, typename Period>
+    inline constexpr BasicDuration<Rep, Period> operator*(const BasicDuration<Rep, Period> &lhs, const long long &coefficient)
     {
-        return Duration::fromMillis(lhs.value * coefficient);
+        return BasicDuration<Rep, Period>::fromTicks(lhs.value * coefficient);
     }
 
     /// @brief Checks if one Moment is less than another.
     /// @param lhs First Moment.
     /// @param rhs Second Moment.
     /// @return True if lhs < rhs.
-    inline constexpr bool operator<(const Moment &lhs, const Moment &rhs)
+    template <typename Rep, typename Period>
+    inline constexpr bool operator<(const BasicMoment<Rep, Period> &lhs, const BasicMoment<Rep, Period> &rhs)
     {
         return lhs.value < rhs.value;
     }
@@ -198,7 +477,8 @@ namespace fenz
     /// @param lhs First Moment.
     /// @param rhs Second Moment.
     /// @return True if lhs > rhs.
-    inline constexpr bool operator>(const Moment &lhs, const Moment &rhs)
+    template <typename Rep, typename Period>
+    inline constexpr bool operator>(const BasicMoment<Rep, Period> &lhs, const BasicMoment<Rep, Period> &rhs)
     {
         return lhs.value > rhs.value;
     }
@@ -206,7 +486,8 @@ namespace fenz
     /// @param lhs First Moment.
     /// @param rhs Second Moment.
     /// @return True if lhs <= rhs.
-    inline constexpr bool operator<=(const Moment &lhs, const Moment &rhs)
+    template <typename Rep, typename Period>
+    inline constexpr bool operator<=(const BasicMoment<Rep, Period> &lhs, const BasicMoment<Rep, Period> &rhs)
     {
         return lhs.value <= rhs.value;
     }
@@ -214,7 +495,8 @@ namespace fenz
     /// @param lhs First Moment.
     /// @param rhs Second Moment.
     /// @return True if lhs >= rhs.
-    inline constexpr bool operator>=(const Moment &lhs, const Moment &rhs)
+    template <typename Rep, typename Period>
+    inline constexpr bool operator>=(const BasicMoment<Rep, Period> &lhs, const BasicMoment<Rep, Period> &rhs)
     {
         return lhs.value >= rhs.value;
     }
@@ -222,51 +504,64 @@ namespace fenz
     /// @param lhs First Moment.
     /// @param rhs Second Moment.
     /// @return True if lhs == rhs.
-    inline constexpr bool operator==(const Moment &lhs, const Moment &rhs)
+    template <typename Rep, typename Period>
+    inline constexpr bool operator==(const BasicMoment<Rep, Period> &lhs, const BasicMoment<Rep, Period> &rhs)
     {
         return lhs.value == rhs.value;
     }
 
     /// @brief Checks if one Duration is less than another.
+    /// @details Durations of different tick lengths are compared exactly, in ticks of their CommonDuration. The same
+    ///          applies to the other comparisons.
     /// @param lhs First Duration.
     /// @param rhs Second Duration.
     /// @return True if lhs < rhs.
-    inline constexpr bool operator<(const Duration &lhs, const Duration &rhs)
+    template <typename Rep1, typename Period1, typename Rep2, typename Period2>
+    inline constexpr bool operator<(const BasicDuration<Rep1, Period1> &lhs, const BasicDuration<Rep2, Period2> &rhs)
     {
-        return lhs.value < rhs.value;
+        typedef typename CommonDuration<BasicDuration<Rep1, Period1>, BasicDuration<Rep2, Period2>>::type Common;
+        return Common(lhs).value < Common(rhs).value;
     }
     /// @brief Checks if one Duration is greater than another.
     /// @param lhs First Duration.
     /// @param rhs Second Duration.
     /// @return True if lhs > rhs.
-    inline constexpr bool operator>(const Duration &lhs, const Duration &rhs)
+    template <typename Rep1, typename Period1, typename Rep2, typename Period2>
+    inline constexpr bool operator>(const BasicDuration<Rep1, Period1> &lhs, const BasicDuration<Rep2, Period2> &rhs)
     {
-        return lhs.value > rhs.value;
+        typedef typename CommonDuration<BasicDuration<Rep1, Period1>, BasicDuration<Rep2, Period2>>::type Common;
+        return Common(lhs).value > Common(rhs).value;
     }
     /// @brief Checks if one Duration is less than or equal to another.
     /// @param lhs First Duration.
     /// @param rhs Second Duration.
     /// @return True if lhs <= rhs.
-    inline constexpr bool operator<=(const Duration &lhs, const Duration &rhs)
+    template <typename Rep1, typename Period1, typename Rep2, typename Period2>
+    inline constexpr bool operator<=(const BasicDuration<Rep1, Period1> &lhs, const BasicDuration<Rep2, Period2> &rhs)
     {
-        return lhs.value <= rhs.value;
+        typedef typename CommonDuration<BasicDuration<Rep1, Period1>, BasicDuration<Rep2, Period2>>::type Common;
+        return Common(lhs).value <= Common(rhs).value;
     }
     /// @brief Checks if one Duration is greater than or equal to another.
     /// @param lhs First Duration.
     /// @param rhs Second Duration.
     /// @return True if lhs >= rhs.
-    inline constexpr bool operator>=(const Duration &lhs, const Duration &rhs)
+    template <typename Rep1, typename Period1, typename Rep2, typename Period2>
+    inline constexpr bool operator>=(const BasicDuration<Rep1, Period1> &lhs, const BasicDuration<Rep2, Period2> &rhs)
     {
-        return lhs.value >= rhs.value;
+        typedef typename CommonDuration<BasicDuration<Rep1, Period1>, BasicDuration<Rep2, Period2>>::type Common;
+        return Common(lhs).value >= Common(rhs).value;
     }
     /// @brief Checks if two Durations are equal.
     /// @param lhs First Duration.
     /// @param rhs Second Duration.
     /// @return True if lhs == rhs.
-    inline constexpr bool operator==(const Duration &lhs, const Duration &rhs)
+    template <typename Rep1, typename Period1, typename Rep2, typename Period2>
+    inline constexpr bool operator==(const BasicDuration<Rep1, Period1> &lhs, const BasicDuration<Rep2, Period2> &rhs)
     {
-        return lhs.value == rhs.value;
+        typedef typename CommonDuration<BasicDuration<Rep1, Period1>, BasicDuration<Rep2, Period2>>::type Common;
+        return Common(lhs).value == Common(rhs).value;
     }
 }
 
-#endif // FENZ_TIME_HPP
\ No newline at end of file
+#endif // FENZ_TIME_HPP
@@ -0,0 +1,361 @@
+#include "bitarray.hpp"
+#include "option.hpp"
+#include "time.hpp"
+
+#ifndef FENZ_TIMER_WHEEL_HPP
+#define FENZ_TIMER_WHEEL_HPP
+
+namespace fenz
+{
+    /// @brief Identifies a timer scheduled on a TimerWheel, for cancelling it.
+    /// @details Handles of timers that have fired or been cancelled become stale, and are safely rejected by `cancel`.
+    struct TimerHandle
+    {
+        /// The storage slot of the timer.
+        unsigned int index;
+        /// Distinguishes this timer from earlier and later timers that used the same slot.
+        unsigned int generation;
+    };
+
+    /// @brief A hierarchical timer wheel with a fixed number of timers.
+    /// @details Time is divided into ticks of a fixed resolution. Timers are kept in four levels of 64 slots, where each
+    ///          level's slots are 64 times wider than the previous level's. Timers further away than the top level are
+    ///          kept in an overflow list. As time advances, timers cascade down to finer levels until they fire.
+    ///          Scheduling and cancelling are O(1), and advancing costs O(1) per fired timer plus O(1) per 64 ticks.
+    ///          All storage is inline.
+    /// @tparam T The type of item stored with each timer, passed back when the timer fires. Must be default constructible.
+    /// @tparam Capacity The maximum number of timers that can be scheduled at the same time.
+    /// @tparam MomentType The Moment type of deadlines.
+    template <typename T, unsigned int Capacity, typename MomentType = Moment>
+    class TimerWheel
+    {
+        static_assert(Capacity > 0, "TimerWheel capacity must be greater than zero");
+
+    public:
+        /// The Duration type matching `MomentType`.
+        typedef decltype(MomentType::now() - MomentType::now()) DurationType;
+
+    private:
+        static constexpr int Levels = 4;
+        static constexpr int SlotBits = 6;
+        static constexpr int Slots = 1 << SlotBits;
+        static constexpr unsigned int None = Capacity;
+        /// The list index used for timers beyond the top level.
+        static constexpr int OverflowList = Levels * Slots;
+        /// The list index used for timers whose deadline had already passed when they were scheduled.
+        static constexpr int DueList = OverflowList + 1;
+
+        struct Node
+        {
+            T item;
+            unsigned long long expiry;
+            unsigned int next;
+            unsigned int prev;
+            unsigned int generation;
+            /// The list the node is in, or -1 if it is free or being fired.
+            int list;
+        };
+
+        Node nodes_[Capacity];
+        unsigned int heads_[DueList + 1];
+        /// One bit per slot of each level, set if the slot's list is not empty.
+        unsigned long long occupied_[Levels];
+        unsigned int freeHead_;
+        unsigned int count_;
+
+        MomentType origin_;
+        DurationType resolution_;
+        /// The last tick that has been processed.
+        unsigned long long currentTick_;
+
+        void link(unsigned int index, int list)
+        {
+            Node &node = nodes_[index];
+            node.list = list;
+            node.prev = None;
+            node.next = heads_[list];
+            if (node.next != None)
+            {
+                nodes_[node.next].prev = index;
+            }
+            heads_[list] = index;
+            if (list < OverflowList)
+            {
+                occupied_[list / Slots] |= 1ULL << (list % Slots);
+            }
+        }
+
+        void unlink(unsigned int index)
+        {
+            Node &node = nodes_[index];
+            if (node.prev != None)
+            {
+                nodes_[node.prev].next = node.next;
+            }
+            else
+            {
+                heads_[node.list] = node.next;
+                if (node.next == None && node.list < OverflowList)
+                {
+                    occupied_[node.list / Slots] &= ~(1ULL << (node.list % Slots));
+                }
+            }
+            if (node.next != None)
+            {
+                nodes_[node.next].prev = node.prev;
+            }
+        }
+
+        /// @brief Returns the list that a timer expiring at `expiry` belongs in, given the current tick.
+        int listFor(unsigned long long expiry) const
+        {
+            for (int level = 0; level < Levels; ++level)
+            {
+                int shift = SlotBits * (level + 1);
+                if ((expiry >> shift) == (currentTick_ >> shift))
+                {
+                    return level * Slots + static_cast<int>((expiry >> (SlotBits * level)) & (Slots - 1));
+                }
+            }
+            return OverflowList;
+        }
+
+        /// @brief Moves all timers in a list to the lists they now belong in.
+        void cascade(int list)
+        {
+            unsigned int index = heads_[list];
+            heads_[list] = None;
+            if (list < OverflowList)
+            {
+                occupied_[list / Slots] &= ~(1ULL << (list % Slots));
+            }
+            while (index != None)
+            {
+                unsigned int next = nodes_[index].next;
+                link(index, listFor(nodes_[index].expiry));
+                index = next;
+            }
+        }
+
+        void release(unsigned int index)
+        {
+            Node &node = nodes_[index];
+            node.list = -1;
+            node.generation++;
+            node.next = freeHead_;
+            freeHead_ = index;
+            count_--;
+        }
+
+        /// @brief Removes all timers from a list and fires them.
+        template <typename Func>
+        void fire(int list, Func &func)
+        {
+            unsigned int index = heads_[list];
+            heads_[list] = None;
+            if (list < OverflowList)
+            {
+                occupied_[0] &= ~(1ULL << list);
+            }
+            // Mark every detached timer as fired before calling back, so that a callback cannot cancel a timer that
+            // is still waiting to be fired from this list
+            for (unsigned int firing = index; firing != None; firing = nodes_[firing].next)
+            {
+                nodes_[firing].list = -1;
+            }
+            while (index != None)
+            {
+                unsigned int next = nodes_[index].next;
+                T item = nodes_[index].item;
+                release(index);
+                func(item);
+                index = next;
+            }
+        }
+
+        /// @brief Processes the tick after the current one: cascades timers at level boundaries, then fires the timers of the tick.
+        template <typename Func>
+        void step(Func &func)
+        {
+            unsigned long long tick = ++currentTick_;
+            if ((tick & ((1ULL << (SlotBits * Levels)) - 1)) == 0)
+            {
+                cascade(OverflowList);
+            }
+            for (int level = Levels - 1; level > 0; --level)
+            {
+                if ((tick & ((1ULL << (SlotBits * level)) - 1)) == 0)
+                {
+                    cascade(level * Slots + static_cast<int>((tick >> (SlotBits * level)) & (Slots - 1)));
+                }
+            }
+
+            fire(static_cast<int>(tick & (Slots - 1)), func);
+        }
+
+        /// @brief Returns the number of whole ticks from the origin to a Moment, rounding down.
+        unsigned long long ticksUntil(const MomentType &moment) const
+        {
+            DurationType elapsed = moment - origin_;
+            return elapsed.count() <= 0 ? 0 : static_cast<unsigned long long>(elapsed.count() / resolution_.count());
+        }
+
+    public:
+        /// @brief Constructs an empty TimerWheel.
+        /// @param start The Moment that time starts at, usually `MomentType::now()`.
+        /// @param resolution The length of one tick. Timers never fire early, and fire at most one tick late.
+        TimerWheel(MomentType start, DurationType resolution = DurationType::fromTicks(1))
+            : freeHead_(0), count_(0), origin_(start), resolution_(resolution), currentTick_(0)
+        {
+            for (unsigned int i = 0; i < Capacity; ++i)
+            {
+                nodes_[i].next = i + 1;
+                nodes_[i].generation = 0;
+                nodes_[i].list = -1;
+            }
+            for (int list = 0; list <= DueList; ++list)
+            {
+                heads_[list] = None;
+            }
+            for (int level = 0; level < Levels; ++level)
+            {
+                occupied_[level] = 0;
+            }
+        }
+
+        TimerWheel(const TimerWheel &) = delete;
+        TimerWheel &operator=(const TimerWheel &) = delete;
+
+        /// @brief Schedules a timer.
+        /// @param deadline The Moment at which the timer fires. Deadlines that have already passed fire on the next `advance`.
+        /// @param item The item to pass back when the timer fires.
+        /// @return An Option containing the handle of the timer, or an empty Option if the wheel is full.
+        Option<TimerHandle> schedule(const MomentType &deadline, const T &item)
+        {
+            if (isFull())
+            {
+                return Option<TimerHandle>();
+            }
+
+            // Round up, so that timers never fire before their deadline
+            DurationType offset = deadline - origin_;
+            unsigned long long expiry = offset.count() <= 0 ? 0 : static_cast<unsigned long long>((offset.count() + resolution_.count() - 1) / resolution_.count());
+
+            unsigned int index = freeHead_;
+            freeHead_ = nodes_[index].next;
+            count_++;
+            nodes_[index].item = item;
+            nodes_[index].expiry = expiry;
+            link(index, expiry <= currentTick_ ? DueList : listFor(expiry));
+            return Option<TimerHandle>(TimerHandle{index, nodes_[index].generation});
+        }
+
+        /// @brief Schedules a timer to fire after a Duration.
+        /// @param now The current Moment.
+        /// @param delay How long after `now` the timer fires.
+        /// @param item The item to pass back when the timer fires.
+        /// @return An Option containing the handle of the timer, or an empty Option if the wheel is full.
+        Option<TimerHandle> scheduleAfter(const MomentType &now, const DurationType &delay, const T &item)
+        {
+            return schedule(now + delay, item);
+        }
+
+        /// @brief Cancels a scheduled timer.
+        /// @param handle The handle returned when the timer was scheduled.
+        /// @return True if the timer was cancelled, false if it already fired or was cancelled.
+        bool cancel(const TimerHandle &handle)
+        {
+            if (!isScheduled(handle))
+            {
+                return false;
+            }
+            unlink(handle.index);
+            release(handle.index);
+            return true;
+        }
+
+        /// @brief Checks if a timer is still scheduled.
+        /// @param handle The handle returned when the timer was scheduled.
+        /// @return True if the timer has neither fired nor been cancelled.
+        bool isScheduled(const TimerHandle &handle) const
+        {
+            return handle.index < Capacity && nodes_[handle.index].list >= 0 && nodes_[handle.index].generation == handle.generation;
+        }
+
+        /// @brief Advances time, firing all timers whose deadline has passed.
+        /// @details Timers whose deadline had already passed when they were scheduled are fired first. The rest are fired
+        ///          in order of their tick; timers expiring in the same tick are fired together.
+        ///          Ticks with no timers are skipped a whole level-0 slot range at a time.
+        /// @param now The current Moment.
+        /// @param func The function to call for each fired timer. This function should take a single argument of type `T&`.
+        ///        It may schedule and cancel timers. Timers due in the same tick are already being fired, so cancelling
+        ///        them returns false.
+        /// @return The number of timers fired.
+        template <typename Func>
+        unsigned int advance(const MomentType &now, Func func)
+        {
+            unsigned long long target = ticksUntil(now);
+            unsigned int fired = 0;
+            auto counting = [&fired, &func](T &item)
+            {
+                fired++;
+                func(item);
+            };
+
+            fire(DueList, counting);
+
+            while (currentTick_ < target)
+            {
+                if (count_ == 0)
+                {
+                    currentTick_ = target;
+                    break;
+                }
+
+                // Find the next tick that has timers in level 0, or the next level boundary, whichever comes first
+                unsigned int position = static_cast<unsigned int>(currentTick_ & (Slots - 1));
+                unsigned long long ahead = position == Slots - 1 ? 0 : occupied_[0] & (~0ULL << (position + 1));
+                unsigned long long next = ahead != 0 ? currentTick_ - position + static_cast<unsigned long long>(detail::countTrailingZeros64(ahead))
+                                                     : (currentTick_ | (Slots - 1)) + 1;
+                if (next > target)
+                {
+                    currentTick_ = target;
+                    break;
+                }
+                currentTick_ = next - 1;
+                step(counting);
+            }
+            return fired;
+        }
+
+        /// @brief Returns the number of scheduled timers.
+        /// @return The number of scheduled timers.
+        constexpr unsigned int size() const
+        {
+            return count_;
+        }
+
+        /// @brief Returns the maximum number of timers.
+        /// @return The maximum number of timers.
+        constexpr unsigned int capacity() const
+        {
+            return Capacity;
+        }
+
+        /// @brief Checks if no more timers can be scheduled.
+        /// @return True if the wheel is full, false otherwise.
+        bool isFull() const
+        {
+            return count_ == Capacity;
+        }
+
+        /// @brief Checks if no timers are scheduled.
+        /// @return True if the wheel is empty, false otherwise.
+        bool isEmpty() const
+        {
+            return count_ == 0;
+        }
+    };
+}
+
+#endif // FENZ_TIMER_WHEEL_HPP
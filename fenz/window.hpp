@@ -0,0 +1,293 @@
+#include "deque.hpp"
+#include "option.hpp"
+#include "time.hpp"
+
+#ifndef FENZ_WINDOW_HPP
+#define FENZ_WINDOW_HPP
+
+#include <cmath>
+
+namespace fenz
+{
+    /// @brief Counts events in a sliding time window, e.g. "requests in the last 10 seconds".
+    /// @details The window is a ring of `Buckets` slots of a fixed Duration. Events are counted in the slot of their
+    ///          time, and slots are cleared as time moves past them, so the window slides one slot at a time. Adding and
+    ///          querying are O(1), plus clearing at most `Buckets` slots when time has moved forward.
+    /// @tparam Buckets The number of slots in the window. More slots make the window slide more smoothly.
+    /// @tparam MomentType The Moment type of event times.
+    template <unsigned int Buckets, typename MomentType = Moment>
+    class SlidingWindowCounter
+    {
+        static_assert(Buckets > 0, "SlidingWindowCounter must have at least one bucket");
+
+    public:
+        /// The Duration type matching `MomentType`.
+        typedef decltype(MomentType::now() - MomentType::now()) DurationType;
+
+    private:
+        unsigned long long counts_[Buckets];
+        unsigned long long total_;
+        MomentType origin_;
+        DurationType slot_;
+        /// The slot of the newest event or query.
+        long long current_;
+
+        long long slotOf(const MomentType &time) const
+        {
+            long long ticks = (time - origin_).count();
+            return ticks <= 0 ? 0 : ticks / slot_.count();
+        }
+
+        /// @brief Moves the window forward to a slot, clearing the slots it moves past.
+        void slide(long long slot)
+        {
+            if (slot <= current_)
+            {
+                return;
+            }
+            if (slot - current_ >= static_cast<long long>(Buckets))
+            {
+                clear();
+            }
+            else
+            {
+                for (long long cleared = current_ + 1; cleared <= slot; ++cleared)
+                {
+                    unsigned long long &count = counts_[cleared % Buckets];
+                    total_ -= count;
+                    count = 0;
+                }
+            }
+            current_ = slot;
+        }
+
+    public:
+        /// @brief Constructs an empty SlidingWindowCounter.
+        /// @param slot The length of one slot. The window is `Buckets` slots long.
+        /// @param start The Moment to measure time from, usually `MomentType::now()`.
+        SlidingWindowCounter(DurationType slot, MomentType start)
+            : total_(0), origin_(start), slot_(slot), current_(0)
+        {
+            clear();
+        }
+
+        /// @brief Counts events.
+        /// @param time The time of the events. Events older than the window are ignored.
+        /// @param count The number of events.
+        void add(const MomentType &time, unsigned long long count = 1)
+        {
+            long long slot = slotOf(time);
+            slide(slot);
+            if (current_ - slot < static_cast<long long>(Buckets))
+            {
+                counts_[slot % Buckets] += count;
+                total_ += count;
+            }
+        }
+
+        /// @brief Returns the number of events in the window ending at a time.
+        /// @param now The current Moment. The window slides forward to it.
+        /// @return The number of events in the last `Buckets` slots, including the current, partly elapsed one.
+        unsigned long long count(const MomentType &now)
+        {
+            slide(slotOf(now));
+            return total_;
+        }
+
+        /// @brief Returns the rate of events in the window ending at a time.
+        /// @param now The current Moment. The window slides forward to it.
+        /// @return The number of events in the window per second of window length.
+        double perSecond(const MomentType &now)
+        {
+            return static_cast<double>(count(now)) / window().seconds();
+        }
+
+        /// @brief Returns the length of the window.
+        /// @return `Buckets` times the slot length.
+        DurationType window() const
+        {
+            return slot_ * static_cast<long long>(Buckets);
+        }
+
+        /// @brief Removes all events.
+        void clear()
+        {
+            for (unsigned int bucket = 0; bucket < Buckets; ++bucket)
+            {
+                counts_[bucket] = 0;
+            }
+            total_ = 0;
+        }
+    };
+
+    /// @brief An exponentially weighted moving average of samples taken at irregular times.
+    /// @details Each sample's weight halves every `halfLife` after it is taken, so the average reflects recent samples
+    ///          regardless of how often samples arrive. Uses constant memory and one `exp2` per sample.
+    /// @tparam MomentType The Moment type of sample times.
+    template <typename MomentType = Moment>
+    class Ewma
+    {
+    public:
+        /// The Duration type matching `MomentType`.
+        typedef decltype(MomentType::now() - MomentType::now()) DurationType;
+
+    private:
+        DurationType halfLife_;
+        double weightedSum_;
+        double weight_;
+        Option<MomentType> last_;
+
+    public:
+        /// @brief Constructs an Ewma with no samples.
+        /// @param halfLife How long it takes for a sample's weight to halve.
+        explicit Ewma(DurationType halfLife) : halfLife_(halfLife), weightedSum_(0.0), weight_(0.0) {}
+
+        /// @brief Adds a sample.
+        /// @param value The sample.
+        /// @param time The time of the sample. Samples older than the newest one are treated as taken at the same time.
+        void add(double value, const MomentType &time)
+        {
+            if (last_.hasValue())
+            {
+                double elapsed = static_cast<double>((time - last_.value_unsafely()).count());
+                if (elapsed > 0.0)
+                {
+                    double decay = std::exp2(-elapsed / static_cast<double>(halfLife_.count()));
+                    weightedSum_ *= decay;
+                    weight_ *= decay;
+                    last_ = time;
+                }
+            }
+            else
+            {
+                last_ = time;
+            }
+            weightedSum_ += value;
+            weight_ += 1.0;
+        }
+
+        /// @brief Returns the average.
+        /// @return An Option containing the average, or an empty Option if no samples were added.
+        Option<double> value() const
+        {
+            return weight_ > 0.0 ? Option<double>(weightedSum_ / weight_) : Option<double>();
+        }
+
+        /// @brief Returns the half-life of sample weights.
+        /// @return The half-life.
+        DurationType halfLife() const
+        {
+            return halfLife_;
+        }
+
+        /// @brief Removes all samples.
+        void clear()
+        {
+            weightedSum_ = 0.0;
+            weight_ = 0.0;
+            last_ = Option<MomentType>();
+        }
+    };
+
+    /// @brief Tracks the minimum and maximum of the samples in a sliding time window.
+    /// @details Keeps two monotonic deques of candidates, so adding is amortized O(1) and querying is O(1).
+    ///          Each deque only holds samples that can still become the minimum or maximum, which is usually far fewer
+    ///          than all samples in the window.
+    /// @tparam T The type of samples. Must be default constructible and comparable with `<`.
+    /// @tparam Capacity The maximum number of candidates kept for each of the minimum and maximum. If more are needed,
+    ///         e.g. because samples keep rising while the minimum is tracked, the oldest candidate is dropped early.
+    /// @tparam MomentType The Moment type of sample times.
+    template <typename T, unsigned int Capacity, typename MomentType = Moment>
+    class SlidingMinMax
+    {
+    public:
+        /// The Duration type matching `MomentType`.
+        typedef decltype(MomentType::now() - MomentType::now()) DurationType;
+
+    private:
+        struct Entry
+        {
+            T value;
+            /// The time of the sample in ticks of `MomentType`.
+            typename MomentType::rep time;
+        };
+
+        Deque<Entry, Capacity> min_;
+        Deque<Entry, Capacity> max_;
+        DurationType window_;
+
+        /// @brief Removes candidates that have left the window ending at `now`.
+        static void expire(Deque<Entry, Capacity> &candidates, typename MomentType::rep oldest)
+        {
+            while (!candidates.isEmpty() && candidates.front().value_unsafely().time <= oldest)
+            {
+                candidates.popFront();
+            }
+        }
+
+        void expire(const MomentType &now)
+        {
+            typename MomentType::rep oldest = (now - window_).value;
+            expire(min_, oldest);
+            expire(max_, oldest);
+        }
+
+    public:
+        /// @brief Constructs an empty SlidingMinMax.
+        /// @param window The length of the window. Samples at least this old are dropped.
+        explicit SlidingMinMax(DurationType window) : window_(window) {}
+
+        /// @brief Adds a sample.
+        /// @param value The sample.
+        /// @param time The time of the sample. Times must not decrease from one sample to the next.
+        void add(const T &value, const MomentType &time)
+        {
+            expire(time);
+            Entry entry = {value, time.value};
+            while (!min_.isEmpty() && !(min_.back().value_unsafely().value < value))
+            {
+                min_.popBack();
+            }
+            min_.forcePushBack(entry);
+            while (!max_.isEmpty() && !(value < max_.back().value_unsafely().value))
+            {
+                max_.popBack();
+            }
+            max_.forcePushBack(entry);
+        }
+
+        /// @brief Returns the minimum of the samples in the window ending at a time.
+        /// @param now The current Moment. Samples that have left the window are dropped.
+        /// @return An Option containing the minimum, or an empty Option if the window is empty.
+        Option<T> min(const MomentType &now)
+        {
+            expire(now);
+            return min_.isEmpty() ? Option<T>() : Option<T>(min_.front().value_unsafely().value);
+        }
+
+        /// @brief Returns the maximum of the samples in the window ending at a time.
+        /// @param now The current Moment. Samples that have left the window are dropped.
+        /// @return An Option containing the maximum, or an empty Option if the window is empty.
+        Option<T> max(const MomentType &now)
+        {
+            expire(now);
+            return max_.isEmpty() ? Option<T>() : Option<T>(max_.front().value_unsafely().value);
+        }
+
+        /// @brief Returns the length of the window.
+        /// @return The window length.
+        DurationType window() const
+        {
+            return window_;
+        }
+
+        /// @brief Removes all samples.
+        void clear()
+        {
+            min_.clear();
+            max_.clear();
+        }
+    };
+}
+
+#endif // FENZ_WINDOW_HPP
@@ -0,0 +1,67 @@
+// Known-answer tests for fenz/hash.hpp. The Hash64 values are those of the reference XXH64.
+//
+// Build and run from the repository root:
+//     g++ -std=c++14 -Wall -Wextra -fsanitize=address,undefined -I. tests/hash.cpp -o hash-test
+//     ./hash-test
+//
+// Exits with a non-zero status and prints the failed check if a test fails.
+
+#include "../fenz/hash.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+#define CHECK(condition)                                                                       \
+    do                                                                                         \
+    {                                                                                          \
+        if (!(condition))                                                                      \
+        {                                                                                      \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            std::exit(EXIT_FAILURE);                                                           \
+        }                                                                                      \
+    } while (0)
+
+static_assert(fenz::hash64Literal("") == 0xEF46DB3751D8E999ULL, "XXH64 of no bytes");
+static_assert(fenz::hash64Literal("123456789") == 0x8CB841DB40E6AE83ULL, "XXH64 of \"123456789\"");
+static_assert(fenz::crc32cLiteral("123456789") == 0xE3069283u, "CRC-32C check value");
+
+namespace
+{
+    /// Two 32-byte stripes followed by a tail, so that every step of the hash is covered.
+    constexpr char longText[] = "The quick brown fox jumps over the lazy dog, then naps in the sun.";
+    constexpr unsigned long long longTextHash = 0x1721074EB5EF27A5ULL;
+    constexpr unsigned long long longTextHashSeed42 = 0xFD9175D7E0B9DFD1ULL;
+
+    static_assert(fenz::hash64Literal(longText) == longTextHash, "XXH64 of the long text");
+    static_assert(fenz::hash64Literal(longText, 42) == longTextHashSeed42, "XXH64 of the long text, seed 42");
+
+    /// The run-time hash must match the compile-time one.
+    void testOneShot()
+    {
+        fenz::Span<const char> text(longText, sizeof(longText) - 1);
+        CHECK(fenz::hash64(text) == longTextHash);
+        CHECK(fenz::hash64(text, 42) == longTextHashSeed42);
+        CHECK(fenz::hash64(fenz::Span<const char>()) == 0xEF46DB3751D8E999ULL);
+    }
+
+    /// Splitting the input across updates must not change the hash, wherever the split falls.
+    void testStreaming()
+    {
+        const int size = static_cast<int>(sizeof(longText)) - 1;
+        for (int split = 0; split <= size; ++split)
+        {
+            fenz::Hash64 hash(42);
+            hash.update(fenz::Span<const char>(longText, split));
+            hash.update(fenz::Span<const char>(longText + split, size - split));
+            CHECK(hash.value() == longTextHashSeed42);
+        }
+    }
+}
+
+int main()
+{
+    testOneShot();
+    testStreaming();
+    std::printf("hash: all tests passed\n");
+    return EXIT_SUCCESS;
+}
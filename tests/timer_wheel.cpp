@@ -0,0 +1,99 @@
+// Regression tests for fenz/timer_wheel.hpp.
+//
+// Build and run from the repository root:
+//     g++ -std=c++14 -Wall -Wextra -fsanitize=address,undefined -I. tests/timer_wheel.cpp -o timer-wheel-test
+//     ./timer-wheel-test
+//
+// Exits with a non-zero status and prints the failed check if a test fails.
+
+#define FENZ_TIME_SOURCE_MONOTONIC
+
+#include "../fenz/time_sources.hpp"
+
+#include "../fenz/timer_wheel.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+#define CHECK(condition)                                                                       \
+    do                                                                                         \
+    {                                                                                          \
+        if (!(condition))                                                                      \
+        {                                                                                      \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            std::exit(EXIT_FAILURE);                                                           \
+        }                                                                                      \
+    } while (0)
+
+namespace
+{
+    typedef fenz::TimerWheel<int, 4> Wheel;
+
+    /// A callback that cancels the other timers due in the same tick must not unlink them while they are being fired.
+    void testCancelSameTickFromCallback()
+    {
+        fenz::Moment start = fenz::Moment::fromTicks(0);
+        static Wheel wheel(start);
+        static fenz::TimerHandle handles[3];
+        static int fired[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            fenz::Option<fenz::TimerHandle> handle = wheel.schedule(start + fenz::Duration::fromTicks(5), i);
+            CHECK(handle.hasValue());
+            handles[i] = handle.value_unsafely();
+            fired[i] = 0;
+        }
+
+        unsigned int count = wheel.advance(start + fenz::Duration::fromTicks(5), [](int &item)
+                                           {
+                                               fired[item]++;
+                                               for (int i = 0; i < 3; ++i)
+                                               {
+                                                   CHECK(!wheel.isScheduled(handles[i]));
+                                                   CHECK(!wheel.cancel(handles[i]));
+                                               } });
+
+        CHECK(count == 3);
+        for (int i = 0; i < 3; ++i)
+        {
+            CHECK(fired[i] == 1);
+        }
+        CHECK(wheel.isEmpty());
+
+        // The wheel must still be able to hold its full capacity
+        for (int i = 0; i < 4; ++i)
+        {
+            CHECK(wheel.schedule(start + fenz::Duration::fromTicks(10), i).hasValue());
+        }
+        CHECK(wheel.isFull());
+        CHECK(!wheel.schedule(start + fenz::Duration::fromTicks(10), 4).hasValue());
+        CHECK(wheel.advance(start + fenz::Duration::fromTicks(10), [](int &) {}) == 4);
+        CHECK(wheel.isEmpty());
+    }
+
+    /// A callback may still cancel timers due in later ticks.
+    void testCancelLaterTickFromCallback()
+    {
+        fenz::Moment start = fenz::Moment::fromTicks(0);
+        static Wheel wheel(start);
+        static fenz::TimerHandle later = wheel.schedule(start + fenz::Duration::fromTicks(9), 1).value_unsafely();
+        CHECK(wheel.schedule(start + fenz::Duration::fromTicks(3), 0).hasValue());
+
+        static int fired = 0;
+        CHECK(wheel.advance(start + fenz::Duration::fromTicks(20), [](int &item)
+                            {
+                                fired++;
+                                CHECK(item == 0);
+                                CHECK(wheel.cancel(later)); }) == 1);
+        CHECK(fired == 1);
+        CHECK(wheel.isEmpty());
+    }
+}
+
+int main()
+{
+    testCancelSameTickFromCallback();
+    testCancelLaterTickFromCallback();
+    std::printf("timer_wheel: all tests passed\n");
+    return EXIT_SUCCESS;
+}